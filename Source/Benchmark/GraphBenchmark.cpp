@@ -0,0 +1,20 @@
+#include "GraphBenchmark.h"
+#include <cmath>
+
+void GraphBenchmark::run(unsigned int n, double averageDegree)
+{
+	// Expected degree is (n - 1) * PI * xi^2.
+	double xi = std::sqrt(averageDegree / (PI * (n - 1)));
+
+	LOG("Generator;Order;Threads;Vertices;Edge probability;Edges;Neighbor links;Generation [s];Reordering [s];Edges [s];Clustering [s];BFS [s];Distance sum");
+	runPhases<2>(n, xi, SEQUENTIAL_VERTICES, false, 1);
+	runPhases<2>(n, xi, SEQUENTIAL_VERTICES, true, 1);
+	runPhases<2>(n, xi, SEQUENTIAL_VERTICES, true, Parallel::getThreadCount(0));
+	runPhases<2>(n, xi, BULK_VERTICES, true, 1);
+	runPhases<2>(n, xi, BULK_VERTICES, true, Parallel::getThreadCount(0));
+}
+
+double GraphBenchmark::getSeconds(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
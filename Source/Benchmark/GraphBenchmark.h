@@ -0,0 +1,81 @@
+#pragma once
+
+#include "Graph/Graph.h"
+#include <atomic>
+#include <chrono>
+#include <sstream>
+
+#define BENCHMARK_SEED 12345
+#define BENCHMARK_VERTICES 100000
+#define BENCHMARK_AVERAGE_DEGREE 10.0
+#define BENCHMARK_BFS_SOURCES 100
+
+/**
+ * Timing of the graph construction phases (vertex generation, edge building, clustering, breadth-first search) for the
+ * same point set in generation order, in Morton order and in Morton order on all hardware threads, followed by the bulk
+ * vertex generator on one and all threads. Graphs are built with edge metrics only, because the full set of properties
+ * (BFS from every vertex) is not feasible for the large graphs where the memory layout matters. Clustering and BFS are
+ * timed separately through the public per-vertex queries.
+ */
+class GraphBenchmark
+{
+public:
+    /** Run the benchmark for 'n' vertices in 2 dimensions with xi giving specified expected average degree. */
+    static void run(unsigned int n, double averageDegree);
+
+private:
+    /** Build the graph, time clustering and BFS on it and log the time of every phase. */
+    template<unsigned int Dim>
+    static void runPhases(unsigned int n, double xi, VertexEngine vertexEngine, bool reorder, unsigned int threadCount);
+
+    /** Returns seconds elapsed since 'start'. */
+    static double getSeconds(std::chrono::steady_clock::time_point start);
+};
+
+template<unsigned int Dim>
+void GraphBenchmark::runPhases(unsigned int n, double xi, VertexEngine vertexEngine, bool reorder, unsigned int threadCount)
+{
+    GraphOptions options;
+    options.seed = BENCHMARK_SEED;
+    options.adjacencyEngine = SPARSE_ADJACENCY;
+    options.edgeEngine = GRID_EDGES;
+    options.vertexEngine = vertexEngine;
+    options.metricSet = EDGE_METRICS;
+    options.reorderVertices = reorder;
+    options.threadCount = threadCount;
+    options.measurePhases = true;
+
+    const Graph<Dim> graph(n, xi, options);
+    const PhaseTimes phaseTimes = graph.getPhaseTimes();
+    const size_t chunkCount = (size_t)threadCount * PARALLEL_CHUNKS_PER_THREAD;
+
+    auto start = std::chrono::steady_clock::now();
+    std::atomic<unsigned long long> links(0);
+    Parallel::forChunks(n, chunkCount, threadCount, [&](size_t, size_t begin, size_t end)
+    {
+        unsigned long long chunkLinks = 0;
+        for (unsigned int i = (unsigned int)begin; i < end; ++i)
+        {
+            chunkLinks += graph.getNeighborLinks(i);
+        }
+        links += chunkLinks;
+    });
+    double clusteringTime = getSeconds(start);
+
+    // Sources are the same generated vertices in every order (mapped to their current indexes), and the distances
+    // to all vertices are summed, so every order does the same work and gets the same sum for the same point set.
+    start = std::chrono::steady_clock::now();
+    std::atomic<unsigned long long> distanceSum(0);
+    Parallel::forChunks(BENCHMARK_BFS_SOURCES, BENCHMARK_BFS_SOURCES, threadCount, [&](size_t k, size_t, size_t)
+    {
+        unsigned int source = graph.getVertexIndex((unsigned int)((unsigned long long)k * n / BENCHMARK_BFS_SOURCES));
+        distanceSum += graph.getDistanceSum(source, 0);
+    });
+    double bfsTime = getSeconds(start);
+
+    std::ostringstream row;
+    row << (vertexEngine == BULK_VERTICES ? "bulk" : "sequential") << ";" << (reorder ? "Morton order" : "generation order") << ";" << threadCount
+        << ";" << n << ";" << xi << ";" << graph.getExactProperties().edgeCount << ";" << links << ";" << phaseTimes.generation << ";"
+        << phaseTimes.reordering << ";" << phaseTimes.edges << ";" << clusteringTime << ";" << bfsTime << ";" << distanceSum.load();
+    LOG(row.str());
+}
@@ -0,0 +1,187 @@
+#include "DenseAdjacency.h"
+#include <algorithm>
+#include <cassert>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace
+{
+	/** Number of set bits in the word. */
+	inline unsigned int popcount(uint64_t word)
+	{
+#if defined(_MSC_VER) && defined(_M_X64)
+		return (unsigned int)__popcnt64(word);
+#elif defined(__GNUC__)
+		return (unsigned int)__builtin_popcountll(word);
+#else
+		word = word - ((word >> 1) & 0x5555555555555555ULL);
+		word = (word & 0x3333333333333333ULL) + ((word >> 2) & 0x3333333333333333ULL);
+		word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+		return (unsigned int)((word * 0x0101010101010101ULL) >> 56);
+#endif
+	}
+
+	/** Index of the lowest set bit in the (non-zero) word. */
+	inline unsigned int lowestBit(uint64_t word)
+	{
+#if defined(_MSC_VER) && defined(_M_X64)
+		unsigned long index;
+		_BitScanForward64(&index, word);
+		return (unsigned int)index;
+#elif defined(__GNUC__)
+		return (unsigned int)__builtin_ctzll(word);
+#else
+		unsigned int index = 0;
+		while ((word & 1) == 0)
+		{
+			word >>= 1;
+			++index;
+		}
+		return index;
+#endif
+	}
+
+	/**
+	 * Bit-parallel breadth-first search. Next level is the OR of rows of all frontier vertices, without the
+	 * already visited ones. 'visitLevel' is called with every level (as bit set) and its distance from the root.
+	 */
+	template<typename LevelVisitor>
+	void visitLevels(const std::vector<uint64_t> & bits, size_t wordsPerRow, unsigned int rootIndex, LevelVisitor visitLevel)
+	{
+		std::vector<uint64_t> visited = std::vector<uint64_t>(wordsPerRow, 0);
+		std::vector<uint64_t> frontier = std::vector<uint64_t>(wordsPerRow, 0);
+		std::vector<uint64_t> next = std::vector<uint64_t>(wordsPerRow, 0);
+
+		visited[rootIndex / 64] |= 1ULL << (rootIndex % 64);
+		frontier[rootIndex / 64] |= 1ULL << (rootIndex % 64);
+
+		for (unsigned int distance = 1; ; ++distance)
+		{
+			std::fill(next.begin(), next.end(), 0);
+			for (size_t word = 0; word < wordsPerRow; ++word)
+			{
+				for (uint64_t remaining = frontier[word]; remaining != 0; remaining &= remaining - 1)
+				{
+					const uint64_t * row = bits.data() + (word * 64 + lowestBit(remaining)) * wordsPerRow;
+					for (size_t i = 0; i < wordsPerRow; ++i)
+					{
+						next[i] |= row[i];
+					}
+				}
+			}
+
+			bool isEmpty = true;
+			for (size_t i = 0; i < wordsPerRow; ++i)
+			{
+				next[i] &= ~visited[i];
+				visited[i] |= next[i];
+				isEmpty = isEmpty && next[i] == 0;
+			}
+
+			if (isEmpty)
+				return;
+
+			visitLevel(next, distance);
+			frontier.swap(next);
+		}
+	}
+}
+
+DenseAdjacency::DenseAdjacency(const unsigned int vertexCount)
+	: n(vertexCount), wordsPerRow((vertexCount + 63) / 64), bits((size_t)vertexCount * ((vertexCount + 63) / 64), 0)
+{
+}
+
+void DenseAdjacency::addEdge(unsigned int first, unsigned int second)
+{
+	assert(first < n && second < n);
+
+	bits[(size_t)first * wordsPerRow + second / 64] |= 1ULL << (second % 64);
+	bits[(size_t)second * wordsPerRow + first / 64] |= 1ULL << (first % 64);
+}
+
+//////////////////////////////////////////////////////////////////////
+//// Getters
+//////////////////////////////////////////////////////////////////////
+
+unsigned int DenseAdjacency::getDegree(unsigned int index) const
+{
+	const uint64_t * row = getRow(index);
+
+	unsigned int degree = 0;
+	for (size_t i = 0; i < wordsPerRow; ++i)
+	{
+		degree += popcount(row[i]);
+	}
+
+	return degree;
+}
+
+std::vector<unsigned int> DenseAdjacency::getConnectedVerticesIndexes(unsigned int index) const
+{
+	const uint64_t * row = getRow(index);
+
+	std::vector<unsigned int> indexes;
+	for (size_t i = 0; i < wordsPerRow; ++i)
+	{
+		for (uint64_t remaining = row[i]; remaining != 0; remaining &= remaining - 1)
+		{
+			indexes.push_back((unsigned int)(i * 64 + lowestBit(remaining)));
+		}
+	}
+
+	return indexes;
+}
+
+unsigned int DenseAdjacency::getNeighborLinks(unsigned int index) const
+{
+	const uint64_t * row = getRow(index);
+
+	// For every neighbor count the common neighbors. Each link is found from both of its ends.
+	unsigned int links = 0;
+	for (size_t i = 0; i < wordsPerRow; ++i)
+	{
+		for (uint64_t remaining = row[i]; remaining != 0; remaining &= remaining - 1)
+		{
+			const uint64_t * neighborRow = getRow((unsigned int)(i * 64 + lowestBit(remaining)));
+			for (size_t j = 0; j < wordsPerRow; ++j)
+			{
+				links += popcount(row[j] & neighborRow[j]);
+			}
+		}
+	}
+
+	return links / 2;
+}
+
+unsigned long long DenseAdjacency::getDistanceSum(unsigned int rootIndex, unsigned int firstIndex) const
+{
+	const size_t firstWord = firstIndex / 64;
+	const uint64_t firstWordMask = ~0ULL << (firstIndex % 64);
+
+	// Every vertex of the level lies in the same distance, so count only the vertices with index >= firstIndex.
+	unsigned long long distanceSum = 0;
+	visitLevels(bits, wordsPerRow, rootIndex, [&](const std::vector<uint64_t> & level, unsigned int distance)
+	{
+		unsigned int count = firstWord < wordsPerRow ? popcount(level[firstWord] & firstWordMask) : 0;
+		for (size_t i = firstWord + 1; i < wordsPerRow; ++i)
+		{
+			count += popcount(level[i]);
+		}
+
+		distanceSum += (unsigned long long)count * distance;
+	});
+
+	return distanceSum;
+}
+
+//////////////////////////////////////////////////////////////////////
+//// Helper methods
+//////////////////////////////////////////////////////////////////////
+
+const uint64_t * DenseAdjacency::getRow(unsigned int index) const
+{
+	return bits.data() + (size_t)index * wordsPerRow;
+}
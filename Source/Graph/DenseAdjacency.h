@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Adjacency of the graph stored as n x n bit matrix (one row of 64-bit words per vertex). Used instead of
+ * per-vertex index lists for dense graphs, where rows are shorter than the lists and most of the work
+ * (degrees, links between neighbors, breadth-first search) becomes word-level AND/OR and popcount.
+ */
+class DenseAdjacency
+{
+public:
+    /** Default constructor (empty matrix). */
+    DenseAdjacency()
+    {};
+
+    /** Create matrix without edges for specified number of vertices. */
+    explicit DenseAdjacency(const unsigned int vertexCount);
+
+    /** Connect two vertices (both directions). */
+    void addEdge(unsigned int first, unsigned int second);
+
+    //////////////////////////////////////////////////////////////////////
+    //// Getters
+    //////////////////////////////////////////////////////////////////////
+
+    /** Returns number of vertices connected with specified vertex. */
+    unsigned int getDegree(unsigned int index) const;
+
+    /** Return collection of indexes of vertices connected to specified vertex (in ascending order). */
+    std::vector<unsigned int> getConnectedVerticesIndexes(unsigned int index) const;
+
+    /** Returns number of edges between neighbors of specified vertex. */
+    unsigned int getNeighborLinks(unsigned int index) const;
+
+    /** Returns sum of path lengths from specified vertex to every reachable vertex with index >= firstIndex. */
+    unsigned long long getDistanceSum(unsigned int rootIndex, unsigned int firstIndex) const;
+
+private:
+    /** Returns pointer to the first word of the row of specified vertex. */
+    const uint64_t * getRow(unsigned int index) const;
+
+    /** Number of vertices. */
+    unsigned int n = 0;
+
+    /** Number of 64-bit words in a single row. */
+    size_t wordsPerRow = 0;
+
+    /** Rows of the matrix, bit 'j' of row 'i' is set if vertices 'i' and 'j' are connected. */
+    std::vector<uint64_t> bits;
+};
@@ -0,0 +1,68 @@
+#include "DisjointSet.h"
+#include <cassert>
+#include <numeric>
+#include <utility>
+
+DisjointSet::DisjointSet(const unsigned int count)
+	: parents(count), ranks(count, 0), sizes(count, 1), componentCount(count), largestComponentSize(count > 0 ? 1 : 0)
+{
+	std::iota(parents.begin(), parents.end(), 0);
+}
+
+unsigned int DisjointSet::find(unsigned int index)
+{
+	assert(index < parents.size());
+
+	unsigned int root = index;
+	while (parents[root] != root)
+	{
+		root = parents[root];
+	}
+
+	// Path compression: link every element on the path directly to the root (iterative, so long paths are fine).
+	while (parents[index] != root)
+	{
+		unsigned int parent = parents[index];
+		parents[index] = root;
+		index = parent;
+	}
+
+	return root;
+}
+
+bool DisjointSet::unite(unsigned int first, unsigned int second)
+{
+	first = find(first);
+	second = find(second);
+	if (first == second)
+		return false;
+
+	// Union by rank: attach the lower tree below the higher one.
+	if (ranks[first] < ranks[second])
+		std::swap(first, second);
+
+	parents[second] = first;
+	if (ranks[first] == ranks[second])
+		ranks[first] += 1;
+
+	sizes[first] += sizes[second];
+	if (sizes[first] > largestComponentSize)
+		largestComponentSize = sizes[first];
+
+	componentCount -= 1;
+	return true;
+}
+
+//////////////////////////////////////////////////////////////////////
+//// Getters
+//////////////////////////////////////////////////////////////////////
+
+unsigned int DisjointSet::getComponentCount() const
+{
+	return componentCount;
+}
+
+unsigned int DisjointSet::getLargestComponentSize() const
+{
+	return largestComponentSize;
+}
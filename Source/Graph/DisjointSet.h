@@ -0,0 +1,51 @@
+#pragma once
+
+#include <vector>
+
+/**
+ * Disjoint sets of vertices (union-find with path compression and union by rank). Components of the graph are
+ * merged while the edges are generated, so the connectivity, number of components and size of the largest one
+ * are known as soon as the last edge is added, without any additional traversal.
+ */
+class DisjointSet
+{
+public:
+    /** Default constructor (no elements). */
+    DisjointSet()
+    {};
+
+    /** Create 'count' single element sets. */
+    explicit DisjointSet(const unsigned int count);
+
+    /** Returns representative of the set containing specified element. */
+    unsigned int find(unsigned int index);
+
+    /** Merge sets of both elements. Returns true if they were in different sets. */
+    bool unite(unsigned int first, unsigned int second);
+
+    //////////////////////////////////////////////////////////////////////
+    //// Getters
+    //////////////////////////////////////////////////////////////////////
+
+    /** Returns number of disjoint sets. */
+    unsigned int getComponentCount() const;
+
+    /** Returns number of elements in the largest set. */
+    unsigned int getLargestComponentSize() const;
+
+private:
+    /** Parent of every element (representatives are their own parents). */
+    std::vector<unsigned int> parents;
+
+    /** Upper bound of the tree height of every representative. */
+    std::vector<unsigned char> ranks;
+
+    /** Number of elements in the set of every representative. */
+    std::vector<unsigned int> sizes;
+
+    /** Number of disjoint sets. */
+    unsigned int componentCount = 0;
+
+    /** Number of elements in the largest set. */
+    unsigned int largestComponentSize = 0;
+};
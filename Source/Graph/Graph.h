@@ -1,11 +1,19 @@
 ﻿#pragma once
 
 #include "Vertex.h"
+#include "GraphSnapshot.h"
+#include "DenseAdjacency.h"
+#include "DisjointSet.h"
+#include "Utilities/BulkRandom.h"
+#include "Utilities/DistributionCache.h"
+#include "Utilities/Parallel.h"
 #include <vector>
+#include <algorithm>
 #include <cmath>
 #include <queue>
 #include <numeric>
 #include <cassert>
+#include <chrono>
 
 template<unsigned int Dim>
 class Graph
@@ -16,7 +24,14 @@ public:
     {};
 
     /** Create graph with specified number of vertices and probability xi. */
-    Graph(const unsigned int vertexCount, const double xi);
+    Graph(const unsigned int vertexCount, const double xi, const GraphOptions & options = GraphOptions());
+
+    /**
+     * Create graph from the vertices and edges stored in the snapshot. Nothing is copied or constructed again: the
+     * properties are calculated directly on the mapped positions and adjacency ('adjacencyEngine' is ignored), so
+     * the snapshot has to stay open while the graph is used.
+     */
+    explicit Graph(const GraphSnapshot<Dim> & snapshot, const GraphOptions & options = GraphOptions());
 
     //////////////////////////////////////////////////////////////////////
     //// Logging
@@ -38,12 +53,51 @@ public:
     /** Get the probability of edge between two vertices (xi). */
     double getEdgeProbability() const;
 
+    /** Get the seed used to generate vertex positions. */
+    unsigned int getSeed() const;
+
+    /** Get the random generator used to create vertex positions (the seed alone does not determine them). */
+    VertexEngine getVertexEngine() const;
+
+    /** Get the set of calculated exact properties (edges are not stored for CONNECTIVITY_METRICS). */
+    MetricSet getMetricSet() const;
+
+    /**
+     * Get the collection of vertices (their lists of connected vertices are empty with dense adjacency, and the
+     * collection itself is empty for graphs read from a snapshot).
+     */
+    const std::vector<Vertex<Dim>> & getVertices() const;
+
+    /** Return position value of specified vertex for specified axis. */
+    double getVertexAxisValue(unsigned int index, unsigned int axis) const;
+
+    /** Returns number of vertices connected with specified vertex. */
+    unsigned int getVertexDegree(unsigned int index) const;
+
+    /** Return collection of indexes of vertices connected to specified vertex. */
+    std::vector<unsigned int> getConnectedVerticesIndexes(unsigned int index) const;
+
+    /** Returns true if the edges are stored in the bit matrix instead of the per-vertex lists. */
+    bool isUsingDenseAdjacency() const;
+
     /** Get the calculated approximate properties of the graph. */
     ApproximateProperties getApproximateProperties() const;
 
     /** Get the calculated exact properties of the graph. */
     ExactProperties getExactProperties() const;
 
+    /** Get the time of every construction phase (zero unless GraphOptions::measurePhases was set). */
+    PhaseTimes getPhaseTimes() const;
+
+    /** Returns number of edges between neighbors of specified vertex. */
+    unsigned int getNeighborLinks(unsigned int index) const;
+
+    /** Returns sum of path lengths from specified vertex to every reachable vertex with index >= firstIndex. */
+    unsigned long long getDistanceSum(unsigned int rootIndex, unsigned int firstIndex) const;
+
+    /** Returns current index of the vertex generated as 'generatedIndex' (they differ after Morton reordering). */
+    unsigned int getVertexIndex(unsigned int generatedIndex) const;
+
 protected:
     //////////////////////////////////////////////////////////////////////
     //// Parameters
@@ -58,25 +112,76 @@ protected:
     /** Probability of edge between every two vertices. */
     double xi = 0.0;
 
+    /** Seed of the random generators used to create vertex positions. */
+    unsigned int seed = 0;
+
+    /** Random generator used to create vertex positions. */
+    VertexEngine vertexEngine = SEQUENTIAL_VERTICES;
+
 private:
     //////////////////////////////////////////////////////////////////////
     //// Helper methods.
     //////////////////////////////////////////////////////////////////////
 
+    /** Creates 'n' vertices at random positions generated from the seed with specified engine. */
+    void generateVertices(const VertexEngine engine);
+
+    /** Sorts vertices along Morton curve (before the edges are built), so vertices close in space are close in memory. */
+    void reorderVertices();
+
+    /** Chooses the representation of the edges (has to be called after approximate properties are calculated). */
+    void selectAdjacency(const AdjacencyEngine engine);
+
+    /** Connects two vertices in the selected representation. */
+    void connectVertices(unsigned int first, unsigned int second);
+
+    /** Vertices bucketed into the cells of a grid (cells are not smaller than xi). */
+    struct SpatialGrid
+    {
+        /** Number of cells along every axis (0 if the grid is not used). */
+        unsigned int cellsPerAxis = 0;
+
+        /** 'Dim' cell coordinates of every vertex. */
+        std::vector<unsigned int> vertexCells;
+
+        /** Index of the first vertex of every cell in 'cellVertices' (and the total count at the end). */
+        std::vector<unsigned int> cellStart;
+
+        /** Vertices indexes ordered by cells (ascending inside every cell). */
+        std::vector<unsigned int> cellVertices;
+    };
+
+    /** Connects every pair of vertices which are not further from each other than xi. */
+    void buildEdges(const EdgeEngine engine);
+
+    /** Merges components along the edges (without storing them) until a single component remains. */
+    void connectComponents(const SpatialGrid & grid);
+
+    /** Buckets all vertices into the grid cells (counting sort with a shared histogram, split between threads). */
+    void bucketVertices(SpatialGrid & grid) const;
+
+    /**
+     * Calls 'visit(index, other)' for every vertex with higher index not further than xi from specified one.
+     * Checks every vertex (reference method) or only the same and adjacent cells if the grid is used.
+     */
+    template<typename NeighborVisitor>
+    void findNeighbors(unsigned int index, const SpatialGrid & grid, NeighborVisitor visit) const;
+
+    /** Returns distance between two vertices (read from the snapshot if the graph is mapped). */
+    double getDistance(unsigned int first, unsigned int second) const;
+
+    /** Returns number of connected pairs among the vertices in [begin, end). */
+    template<typename IndexIterator>
+    unsigned int countNeighborLinks(IndexIterator begin, IndexIterator end) const;
+
     /** Performs the calculations for the set of exact parameters (i.e. density or average degree). */
     void calculateExactProperties();
 
     /** Performs the calculations for the set of approximate parameters (i.e. expected value of degree). */
     void calculateAppropximateProperties();
 
-    /** Returns true if the graph is connected. */
-    bool checkIfConnected();
-
-    /** Helper function visiting a node (used with checkIfConnected function). */
-    void visitNode(std::vector<unsigned int> & indexes, unsigned int index);
-
     /**  Breadth-first search function used to calculate path lengths from given vertex to every other vertex. */
-    std::vector<unsigned int> breadthFirstSearch(unsigned int rootIndex);
+    std::vector<unsigned int> breadthFirstSearch(unsigned int rootIndex) const;
 
     //////////////////////////////////////////////////////////////////////
     //// Properties
@@ -85,27 +190,98 @@ private:
     /** Collection of vertices (matching template parameter of the graph). */
     std::vector<Vertex<Dim>> vertices;
 
+    /** True if the edges are stored in 'denseAdjacency' instead of the vertices. */
+    bool useDenseAdjacency = false;
+
+    /** Bit matrix of edges used for dense graphs. */
+    DenseAdjacency denseAdjacency;
+
+    /** Current index of every vertex by its generation index (empty if the vertices were not reordered). */
+    std::vector<unsigned int> vertexIndexes;
+
+    /** Mapped snapshot holding the positions and edges (null if the graph was generated). */
+    const GraphSnapshot<Dim> * snapshot = nullptr;
+
+    /** Components of the graph, merged while the edges are added. */
+    DisjointSet components;
+
+    /** Number of threads used to build the graph and calculate its properties. */
+    unsigned int threadCount = 1;
+
+    /** Set of exact properties calculated for the graph. */
+    MetricSet metricSet = ALL_METRICS;
+
     /** Set of approximate parameters of this graph calculated in constructor. */
     ApproximateProperties approximateProperties;
 
     /** Set of exact properties of this graph calculated in constructor. */
     ExactProperties exactProperties;
+
+    /** Time of every construction phase. */
+    PhaseTimes phaseTimes;
 };
 
 template<unsigned int Dim>
-Graph<Dim>::Graph(const unsigned int vertexCount, const double xi)
-    : n(vertexCount), xi(xi)
+Graph<Dim>::Graph(const unsigned int vertexCount, const double xi, const GraphOptions & options)
+    : n(vertexCount), xi(xi), seed(options.seed != RANDOM_SEED ? options.seed : GraphStatics::getRandomSeed()),
+    vertexEngine(options.vertexEngine), threadCount(Parallel::getThreadCount(options.threadCount)), metricSet(options.metricSet)
 {
     assert(n > 1);
 
+    // Approximate properties depend only on 'n' and 'xi'.
+    calculateAppropximateProperties();
+
+    auto phaseStart = std::chrono::steady_clock::now();
+    auto endPhase = [&](double & phaseTime)
+    {
+        if (!options.measurePhases)
+            return;
+
+        auto now = std::chrono::steady_clock::now();
+        phaseTime = std::chrono::duration<double>(now - phaseStart).count();
+        phaseStart = now;
+    };
+
     // Generate random vertices.
-    for (unsigned int i = 0; i < vertexCount; ++i)
+    generateVertices(vertexEngine);
+    endPhase(phaseTimes.generation);
+    if (options.reorderVertices)
+        reorderVertices();
+    endPhase(phaseTimes.reordering);
+
+    // Connectivity alone does not need the edges, so no adjacency is allocated for it.
+    if (metricSet != CONNECTIVITY_METRICS)
+        selectAdjacency(options.adjacencyEngine);
+    buildEdges(options.edgeEngine);
+    endPhase(phaseTimes.edges);
+
+    // Calculate properties.
+    calculateExactProperties();
+    endPhase(phaseTimes.exactProperties);
+};
+
+template<unsigned int Dim>
+Graph<Dim>::Graph(const GraphSnapshot<Dim> & snapshot, const GraphOptions & options)
+    : n(snapshot.getVerticesCount()), xi(snapshot.getEdgeProbability()), seed(snapshot.getSeed()),
+    vertexEngine(snapshot.getVertexEngine()), threadCount(Parallel::getThreadCount(options.threadCount)),
+    metricSet(options.metricSet), snapshot(&snapshot)
+{
+    assert(n > 1);
+    calculateAppropximateProperties();
+
+    // Merge components along the mapped edges (every edge is stored in both directions, so only once per pair).
+    components = DisjointSet(n);
+    for (unsigned int i = 0; i < n; ++i)
     {
-        vertices.push_back(Vertex<Dim>());
+        for (const uint32_t * index = snapshot.getConnectedVerticesBegin(i); index != snapshot.getConnectedVerticesEnd(i); ++index)
+        {
+            if (*index > i)
+                components.unite(i, *index);
+        }
     }
+    exactProperties.edgeCount = snapshot.getEdgeCount();
 
     // Calculate properties.
-    calculateAppropximateProperties();
     calculateExactProperties();
 };
 
@@ -120,6 +296,8 @@ void Graph<Dim>::logHeaders()
     LOG_DELIMITED_DEFAULT("Vertices");
     LOG_DELIMITED_DEFAULT("Edge probability");
     LOG_DELIMITED_DEFAULT("Connected?");
+    LOG_DELIMITED_DEFAULT("Components");
+    LOG_DELIMITED_DEFAULT("Largest component");
     LOG_DELIMITED_DEFAULT("Average degree");
     LOG_DELIMITED_DEFAULT("Expected value of degree");
     LOG_DELIMITED_DEFAULT("Edges");
@@ -139,6 +317,8 @@ void Graph<Dim>::logProperties() const
     LOG_DELIMITED_DEFAULT(n);
     LOG_DELIMITED_DEFAULT(xi);
     LOG_DELIMITED_DEFAULT(exactProperties.isConnected ? "yes" : "no");
+    LOG_DELIMITED_DEFAULT(exactProperties.componentCount);
+    LOG_DELIMITED_DEFAULT(exactProperties.largestComponentSize);
     LOG_DELIMITED_DEFAULT(exactProperties.averageDegree);
     LOG_DELIMITED_DEFAULT(approximateProperties.expectedValueOfDegree);
     LOG_DELIMITED_DEFAULT(exactProperties.edgeCount);
@@ -166,6 +346,60 @@ double Graph<Dim>::getEdgeProbability() const
     return xi;
 }
 
+template<unsigned int Dim>
+unsigned int Graph<Dim>::getSeed() const
+{
+    return seed;
+}
+
+template<unsigned int Dim>
+VertexEngine Graph<Dim>::getVertexEngine() const
+{
+    return vertexEngine;
+}
+
+template<unsigned int Dim>
+MetricSet Graph<Dim>::getMetricSet() const
+{
+    return metricSet;
+}
+
+template<unsigned int Dim>
+const std::vector<Vertex<Dim>> & Graph<Dim>::getVertices() const
+{
+    return vertices;
+}
+
+template<unsigned int Dim>
+double Graph<Dim>::getVertexAxisValue(unsigned int index, unsigned int axis) const
+{
+    return snapshot ? snapshot->getAxisValue(index, axis) : vertices[index].getAxisValue(axis);
+}
+
+template<unsigned int Dim>
+unsigned int Graph<Dim>::getVertexDegree(unsigned int index) const
+{
+    if (snapshot)
+        return snapshot->getDegree(index);
+
+    return useDenseAdjacency ? denseAdjacency.getDegree(index) : vertices[index].getDegree();
+}
+
+template<unsigned int Dim>
+std::vector<unsigned int> Graph<Dim>::getConnectedVerticesIndexes(unsigned int index) const
+{
+    if (snapshot)
+        return std::vector<unsigned int>(snapshot->getConnectedVerticesBegin(index), snapshot->getConnectedVerticesEnd(index));
+
+    return useDenseAdjacency ? denseAdjacency.getConnectedVerticesIndexes(index) : vertices[index].getConnectedVerticesIndexes();
+}
+
+template<unsigned int Dim>
+bool Graph<Dim>::isUsingDenseAdjacency() const
+{
+    return useDenseAdjacency;
+}
+
 template<unsigned int Dim>
 ApproximateProperties Graph<Dim>::getApproximateProperties() const
 {
@@ -178,122 +412,443 @@ ExactProperties Graph<Dim>::getExactProperties() const
     return exactProperties;
 }
 
+template<unsigned int Dim>
+unsigned int Graph<Dim>::getVertexIndex(unsigned int generatedIndex) const
+{
+    return vertexIndexes.empty() ? generatedIndex : vertexIndexes[generatedIndex];
+}
+
+template<unsigned int Dim>
+PhaseTimes Graph<Dim>::getPhaseTimes() const
+{
+    return phaseTimes;
+}
+
 //////////////////////////////////////////////////////////////////////
 //// Helper methods
 //////////////////////////////////////////////////////////////////////
 
 template<unsigned int Dim>
-void Graph<Dim>::calculateExactProperties()
+void Graph<Dim>::generateVertices(const VertexEngine engine)
 {
-    // Common constants.
-    double xi2 = std::pow(xi, 2.0);
-    double pi_Xi2 = PI * xi2;
-
-    // If we find vertex with degree 0, the graph is surely disconnected.
-    bool isSurelyDisconnected = false;
+    vertices.clear();
+    vertices.reserve(n);
 
-    // Prepare properties.
-    unsigned int degreeSum = 0;
-    unsigned int distanceSum = 0;
-    double vertexGroupingSum = 0;
-    exactProperties.vertexProbability.clear();
-    std::vector<double> vertexProbabilityDiff;
+    if (engine == BULK_VERTICES)
+    {
+        // Fill the coordinates of all vertices in one call, then only copy them into the vertices.
+        std::vector<double> coordinates((size_t)n * Dim);
+        BulkRandom::fill(coordinates.data(), coordinates.size(), DEFAULT_MIN_RANGE, DEFAULT_MAX_RANGE, seed, threadCount);
+        for (unsigned int i = 0; i < n; ++i)
+        {
+            std::array<double, Dim> position;
+            std::copy_n(coordinates.begin() + (size_t)i * Dim, Dim, position.begin());
+            vertices.emplace_back(position);
+        }
+        return;
+    }
 
-    // For each vertex...
+    GraphStatics::seedRandomGenerators(seed, Dim);
     for (unsigned int i = 0; i < n; ++i)
     {
-        Vertex<Dim> & v = vertices[i];
+        vertices.push_back(Vertex<Dim>());
+    }
+}
 
-        // ...get all other vertices...
-        for (unsigned int j = i + 1; j < n; ++j)
+template<unsigned int Dim>
+void Graph<Dim>::reorderVertices()
+{
+    // Indexes are not stored anywhere yet, so relabeling is only the permutation of the collection.
+    assert(exactProperties.edgeCount == 0);
+
+    // Sort by Morton key (ties by the original index, so the order is deterministic).
+    std::vector<std::pair<uint64_t, unsigned int>> keys;
+    keys.reserve(n);
+    for (unsigned int i = 0; i < n; ++i)
+    {
+        double position[Dim];
+        for (unsigned int axis = 0; axis < Dim; ++axis)
         {
-            Vertex<Dim> & w = vertices[j];
+            position[axis] = vertices[i].getAxisValue(axis);
+        }
+
+        keys.push_back(std::make_pair(GraphStatics::getMortonKey(position, Dim, DEFAULT_MIN_RANGE, DEFAULT_MAX_RANGE), i));
+    }
+    std::sort(keys.begin(), keys.end());
+
+    std::vector<Vertex<Dim>> sortedVertices;
+    sortedVertices.reserve(n);
+    vertexIndexes.assign(n, 0);
+    for (unsigned int i = 0; i < n; ++i)
+    {
+        sortedVertices.push_back(vertices[keys[i].second]);
+        vertexIndexes[keys[i].second] = i;
+    }
+    vertices.swap(sortedVertices);
+}
+
+template<unsigned int Dim>
+void Graph<Dim>::selectAdjacency(const AdjacencyEngine engine)
+{
+    // Bit rows are cheaper than index lists once the average degree is a noticeable fraction of 'n'.
+    if (engine == AUTO_ADJACENCY)
+        useDenseAdjacency = approximateProperties.averageDensity >= DENSE_DENSITY_THRESHOLD;
+    else
+        useDenseAdjacency = engine == DENSE_ADJACENCY;
+
+    if (useDenseAdjacency)
+        denseAdjacency = DenseAdjacency(n);
+}
 
-            //...check the distance between them and update information about them.
-            double distance = v.getDistanceTo(w);
-            if (distance <= xi)
+template<unsigned int Dim>
+void Graph<Dim>::connectVertices(unsigned int first, unsigned int second)
+{
+    if (useDenseAdjacency)
+    {
+        denseAdjacency.addEdge(first, second);
+    }
+    else
+    {
+        vertices[first].addConnectedVertex(second);
+        vertices[second].addConnectedVertex(first);
+    }
+
+    components.unite(first, second);
+}
+
+template<unsigned int Dim>
+void Graph<Dim>::buildEdges(const EdgeEngine engine)
+{
+    components = DisjointSet(n);
+
+    SpatialGrid grid;
+    if (engine == GRID_EDGES)
+        bucketVertices(grid);
+
+    if (metricSet == CONNECTIVITY_METRICS)
+    {
+        connectComponents(grid);
+        return;
+    }
+
+    if (threadCount == 1)
+    {
+        for (unsigned int i = 0; i < n; ++i)
+        {
+            findNeighbors(i, grid, [&](unsigned int first, unsigned int second)
             {
-                v.addConnectedVertex(j);
-                w.addConnectedVertex(i);
-                degreeSum += 2;
+                connectVertices(first, second);
                 exactProperties.edgeCount += 1;
+            });
+        }
+    }
+    else
+    {
+        // Every chunk of vertices collects its edges in its own buffer. Buffers are merged in chunk order,
+        // so the adjacency is exactly the same as in the serial build.
+        const size_t chunkCount = (size_t)threadCount * PARALLEL_CHUNKS_PER_THREAD;
+        std::vector<std::vector<std::pair<unsigned int, unsigned int>>> buffers(chunkCount);
+        Parallel::forChunks(n, chunkCount, threadCount, [&](size_t chunk, size_t begin, size_t end)
+        {
+            for (unsigned int i = (unsigned int)begin; i < end; ++i)
+            {
+                findNeighbors(i, grid, [&](unsigned int first, unsigned int second)
+                {
+                    buffers[chunk].push_back(std::make_pair(first, second));
+                });
+            }
+        });
+
+        for (auto & buffer : buffers)
+        {
+            for (auto & edge : buffer)
+            {
+                connectVertices(edge.first, edge.second);
             }
+            exactProperties.edgeCount += (unsigned int)buffer.size();
+            std::vector<std::pair<unsigned int, unsigned int>>().swap(buffer);
         }
+    }
+
+    // Keep the same order of connected vertices as the brute force method (grid visits them by cells).
+    if (engine == GRID_EDGES && !useDenseAdjacency)
+    {
+        Parallel::forChunks(n, threadCount, threadCount, [&](size_t, size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; ++i)
+            {
+                vertices[i].sortConnectedVertices();
+            }
+        });
+    }
+}
 
-        // Connected graphs have no 0-degree vertices.
-        if (v.getDegree() == 0)
-            isSurelyDisconnected = true;
-
-        // We're checking the probability for every 0 <= k < n (which is the value of 'i' in this case).
-        double probability = GraphStatics::binomialCoefficient(n - 1, i) *
-            std::pow(pi_Xi2, double(i)) *
-            std::pow(1.0 - pi_Xi2, double(n - 1 - i));
-        exactProperties.vertexProbability.push_back(probability);
-
-        // Get all of vertex 'v' neighbors. For every pair of neighbors (nested loops), check if they are connected.
-        // If they are, increment the grouping sum.
-        auto indexes = v.getConnectedVerticesIndexes();
-        double vertexGroupingFactor = 0.0;
-        for (unsigned int i1 = 0; i1 < indexes.size(); ++i1)
+template<unsigned int Dim>
+void Graph<Dim>::connectComponents(const SpatialGrid & grid)
+{
+    if (threadCount == 1)
+    {
+        for (unsigned int i = 0; i < n && components.getComponentCount() > 1; ++i)
         {
-            unsigned int index1 = indexes[i1];
-            for (unsigned int i2 = i1 + 1; i2 < indexes.size(); ++i2)
+            findNeighbors(i, grid, [&](unsigned int first, unsigned int second)
             {
-                unsigned int index2 = indexes[i2];
+                components.unite(first, second);
+            });
+        }
+
+        return;
+    }
 
-                // Neighbor i1 and i2 are connected, if the distance between them is equal or less than xi.
-                if (vertices[index1].getDistanceTo(vertices[index2]) <= xi)
+    // Chunks of vertices are searched in rounds of 'threadCount' chunks. Edges of every round are merged
+    // before the next one starts, so the search can stop as soon as the graph is connected.
+    const size_t chunkCount = (size_t)threadCount * PARALLEL_CHUNKS_PER_THREAD;
+    std::vector<std::vector<std::pair<unsigned int, unsigned int>>> buffers(threadCount);
+    for (size_t firstChunk = 0; firstChunk < chunkCount && components.getComponentCount() > 1; firstChunk += threadCount)
+    {
+        Parallel::forChunks(threadCount, threadCount, threadCount, [&](size_t k, size_t, size_t)
+        {
+            const size_t chunk = firstChunk + k;
+            for (unsigned int i = (unsigned int)(n * chunk / chunkCount); i < n * (chunk + 1) / chunkCount; ++i)
+            {
+                findNeighbors(i, grid, [&](unsigned int first, unsigned int second)
                 {
-                    vertexGroupingFactor += 1.0;
-                }
+                    buffers[k].push_back(std::make_pair(first, second));
+                });
+            }
+        });
+
+        for (auto & buffer : buffers)
+        {
+            for (auto & edge : buffer)
+            {
+                components.unite(edge.first, edge.second);
             }
+            buffer.clear();
         }
-        if (v.getDegree() > 1)
+    }
+}
+
+template<unsigned int Dim>
+void Graph<Dim>::bucketVertices(SpatialGrid & grid) const
+{
+    // Cells are not smaller than xi, so connected vertices always lie in the same or adjacent cells.
+    // Number of cells is limited to about 'n', so small xi does not allocate mostly empty grids.
+    const double range = DEFAULT_MAX_RANGE - DEFAULT_MIN_RANGE;
+    double cellsPerAxisLimit = std::max(1.0, std::floor(std::pow((double)n, 1.0 / Dim)));
+    if (xi > 0.0)
+        cellsPerAxisLimit = std::min(cellsPerAxisLimit, std::max(1.0, std::floor(range / xi)));
+
+    const unsigned int cellsPerAxis = (unsigned int)cellsPerAxisLimit;
+    const double cellSize = range / cellsPerAxis;
+    unsigned int cellCount = 1;
+    for (unsigned int axis = 0; axis < Dim; ++axis)
+    {
+        cellCount *= cellsPerAxis;
+    }
+
+    grid.cellsPerAxis = cellsPerAxis;
+    grid.vertexCells.assign((size_t)n * Dim, 0);
+    grid.cellStart.assign(cellCount + 1, 0);
+    grid.cellVertices.assign(n, 0);
+
+    auto getCell = [&](unsigned int index)
+    {
+        unsigned int cell = 0;
+        for (unsigned int axis = Dim; axis-- > 0;)
         {
-            vertexGroupingFactor *= 2.0 / v.getDegree() / (v.getDegree() - 1);
+            cell = cell * cellsPerAxis + grid.vertexCells[(size_t)index * Dim + axis];
         }
+        return cell;
+    };
+
+    // Cell coordinates of every vertex (positions outside of the range are clamped to the border cells) and number
+    // of vertices in every cell. The histogram is shared by all threads, so its size does not grow with them.
+    const size_t chunkCount = (size_t)threadCount * PARALLEL_CHUNKS_PER_THREAD;
+    std::vector<std::atomic<unsigned int>> cellCounts(cellCount);
+    for (auto & count : cellCounts)
+    {
+        count.store(0, std::memory_order_relaxed);
+    }
 
-        vertexGroupingSum += vertexGroupingFactor;
+    Parallel::forChunks(n, chunkCount, threadCount, [&](size_t, size_t begin, size_t end)
+    {
+        for (unsigned int i = (unsigned int)begin; i < end; ++i)
+        {
+            for (unsigned int axis = 0; axis < Dim; ++axis)
+            {
+                double coordinate = std::floor((vertices[i].getAxisValue(axis) - DEFAULT_MIN_RANGE) / cellSize);
+                grid.vertexCells[(size_t)i * Dim + axis] =
+                    coordinate <= 0.0 ? 0 : (coordinate >= cellsPerAxis ? cellsPerAxis - 1 : (unsigned int)coordinate);
+            }
+            cellCounts[getCell(i)].fetch_add(1, std::memory_order_relaxed);
+        }
+    });
 
-        // Check paths from vertex v to every other vertex (but not the same pair of vertices more than once).
-        auto distances = breadthFirstSearch(i);
-        for (unsigned int dist = i; dist < distances.size(); ++dist)
+    // Start of every cell. The counts are reused as the next free position in every cell.
+    for (unsigned int cell = 0; cell < cellCount; ++cell)
+    {
+        grid.cellStart[cell + 1] = grid.cellStart[cell] + cellCounts[cell].load(std::memory_order_relaxed);
+        cellCounts[cell].store(grid.cellStart[cell], std::memory_order_relaxed);
+    }
+
+    Parallel::forChunks(n, chunkCount, threadCount, [&](size_t, size_t begin, size_t end)
+    {
+        for (unsigned int i = (unsigned int)begin; i < end; ++i)
         {
-            distanceSum += (distances[dist] != INF ? distances[dist] : 0);
+            grid.cellVertices[cellCounts[getCell(i)].fetch_add(1, std::memory_order_relaxed)] = i;
         }
+    });
+
+    // Threads fill the cells in any order, so every cell is sorted to keep the vertices ascending (a single thread
+    // already fills them in ascending order).
+    if (threadCount > 1)
+    {
+        Parallel::forChunks(cellCount, chunkCount, threadCount, [&](size_t, size_t begin, size_t end)
+        {
+            for (size_t cell = begin; cell < end; ++cell)
+            {
+                std::sort(grid.cellVertices.begin() + grid.cellStart[cell], grid.cellVertices.begin() + grid.cellStart[cell + 1]);
+            }
+        });
+    }
+}
 
-        // Add difference between approximate and exact probability.
-        double probabilityDiff = probability - approximateProperties.vertexProbability[i];
-        if (!std::isnan(probabilityDiff) && std::isfinite(probabilityDiff))
+template<unsigned int Dim>
+template<typename NeighborVisitor>
+void Graph<Dim>::findNeighbors(unsigned int index, const SpatialGrid & grid, NeighborVisitor visit) const
+{
+    const Vertex<Dim> & v = vertices[index];
+
+    // Without the grid get all other vertices and check the distance between them.
+    if (grid.cellsPerAxis == 0)
+    {
+        for (unsigned int j = index + 1; j < n; ++j)
         {
-            vertexProbabilityDiff.push_back(probabilityDiff);
-            exactProperties.averageVertexProbability += probabilityDiff;
+            if (v.getDistanceTo(vertices[j]) <= xi)
+                visit(index, j);
         }
-        else
+
+        return;
+    }
+
+    // Otherwise check vertices in 3^Dim neighboring cells.
+    unsigned int neighborCellCount = 1;
+    for (unsigned int axis = 0; axis < Dim; ++axis)
+    {
+        neighborCellCount *= 3;
+    }
+
+    const unsigned int * cellCoordinates = &grid.vertexCells[(size_t)index * Dim];
+    for (unsigned int offset = 0; offset < neighborCellCount; ++offset)
+    {
+        // Decode the offset as 'Dim' digits in base 3 (-1, 0, +1 on every axis).
+        unsigned int cell = 0;
+        unsigned int digits = offset;
+        unsigned int multiplier = 1;
+        bool isInside = true;
+        for (unsigned int axis = 0; axis < Dim; ++axis)
         {
-            double lastValue = vertexProbabilityDiff[vertexProbabilityDiff.size() - 1];
-            vertexProbabilityDiff.push_back(lastValue);
-            exactProperties.averageVertexProbability += lastValue;
+            int neighborCoordinate = (int)cellCoordinates[axis] + (int)(digits % 3) - 1;
+            digits /= 3;
+            if (neighborCoordinate < 0 || neighborCoordinate >= (int)grid.cellsPerAxis)
+            {
+                isInside = false;
+                break;
+            }
+            cell += (unsigned int)neighborCoordinate * multiplier;
+            multiplier *= grid.cellsPerAxis;
+        }
+        if (!isInside)
+            continue;
+
+        for (unsigned int k = grid.cellStart[cell]; k < grid.cellStart[cell + 1]; ++k)
+        {
+            unsigned int j = grid.cellVertices[k];
+            if (j > index && v.getDistanceTo(vertices[j]) <= xi)
+                visit(index, j);
         }
     }
+}
+
+template<unsigned int Dim>
+void Graph<Dim>::calculateExactProperties()
+{
+    // Components are already merged while adding the edges.
+    exactProperties.componentCount = components.getComponentCount();
+    exactProperties.largestComponentSize = components.getLargestComponentSize();
+    exactProperties.isConnected = exactProperties.componentCount == 1;
+    if (metricSet == CONNECTIVITY_METRICS)
+        return;
+
+    // Edge metrics need no per-vertex pass (every edge adds 2 to the degree sum).
+    exactProperties.density = 2.0 * exactProperties.edgeCount / (n * (n - 1.0));
+    if (metricSet == EDGE_METRICS)
+    {
+        exactProperties.averageDegree = 2.0 * exactProperties.edgeCount / n;
+        return;
+    }
+
+    // Common constants.
+    double xi2 = std::pow(xi, 2.0);
+    double pi_Xi2 = PI * xi2;
+
+    // Prepare properties.
+    unsigned int degreeSum = 0;
+    unsigned long long distanceSum = 0;
+    double vertexGroupingSum = 0;
+
+    // Per-vertex values (edges are already built) are calculated in parallel, but summed below in index order,
+    // so the results do not depend on the number of threads.
+    std::vector<unsigned int> degrees = std::vector<unsigned int>(n);
+    std::vector<unsigned int> neighborLinks = std::vector<unsigned int>(n);
+    std::vector<unsigned long long> distanceSums = std::vector<unsigned long long>(n);
+    Parallel::forChunks(n, (size_t)threadCount * PARALLEL_CHUNKS_PER_THREAD, threadCount, [&](size_t, size_t begin, size_t end)
+    {
+        for (unsigned int i = (unsigned int)begin; i < end; ++i)
+        {
+            degrees[i] = getVertexDegree(i);
+            neighborLinks[i] = getNeighborLinks(i);
+
+            // Check paths from vertex v to every other vertex (but not the same pair of vertices more than once).
+            distanceSums[i] = getDistanceSum(i, i);
+        }
+    });
+
+    // For each vertex...
+    for (unsigned int i = 0; i < n; ++i)
+    {
+        unsigned int degree = degrees[i];
+        degreeSum += degree;
+
+        // Count connected pairs of neighbors of the vertex.
+        double vertexGroupingFactor = neighborLinks[i];
+        if (degree > 1)
+        {
+            vertexGroupingFactor *= 2.0 / degree / (degree - 1);
+        }
+
+        vertexGroupingSum += vertexGroupingFactor;
+        distanceSum += distanceSums[i];
+    }
 
     // Save the properties from the calculated parameters.
     exactProperties.averageDegree = (double)degreeSum / n;
-    exactProperties.density = 2.0 * exactProperties.edgeCount / (n * (n - 1));
-    exactProperties.isConnected = isSurelyDisconnected ? false : checkIfConnected();
-    exactProperties.averagePathLength = 2.0 * (double)distanceSum / (n * (n - 1));
+    exactProperties.averagePathLength = 2.0 * (double)distanceSum / (n * (n - 1.0));
     exactProperties.groupingFactor = vertexGroupingSum / n;
     exactProperties.degreeVariance = pi_Xi2 * (1.0 - xi2) * (n - 1.0);
 
-    // Calculate normalized degree value and variance of differences between exact and approximate vertex probabilities.
-    exactProperties.averageVertexProbability /= n;
+    // Calculate normalized degree value.
     for (unsigned int i = 0; i < n; ++i)
     {
-        exactProperties.normalizedDegreeVariance += std::pow(vertices[i].getDegree() / (n - 1.0) - exactProperties.averageDegree / (n - 1.0), 2.0);
-        exactProperties.vertexProbabilityVariance += std::pow(vertexProbabilityDiff[i] - exactProperties.averageVertexProbability, 2.0);
+        exactProperties.normalizedDegreeVariance += std::pow(degrees[i] / (n - 1.0) - exactProperties.averageDegree / (n - 1.0), 2.0);
     }
     exactProperties.normalizedDegreeVariance /= n;
-    exactProperties.vertexProbabilityVariance /= n;
+
+    // Exact vertex probabilities and their differences from the approximate ones depend only on 'n' and 'xi'.
+    std::shared_ptr<const VertexProbabilities> probabilities = DistributionCache::get(n, xi);
+    exactProperties.vertexProbability = std::shared_ptr<const std::vector<double>>(probabilities, &probabilities->exact);
+    exactProperties.averageVertexProbability = probabilities->averageDifference;
+    exactProperties.vertexProbabilityVariance = probabilities->differenceVariance;
 }
 
 template<unsigned int Dim>
@@ -308,78 +863,113 @@ void Graph<Dim>::calculateAppropximateProperties()
     approximateProperties.expectedValueOfEdgeCount = pi_Xi2 * n * (n - 1) / 2.0;
     approximateProperties.averageDensity = pi_Xi2;
 
-    // Vertex probabilities for every k (0 <= k <= n-1).
-    approximateProperties.vertexProbability.clear();
-    for (unsigned int k = 0; k <= n - 1; ++k)
-    {
-        double probability = std::exp(-1.0 * (n - 1) * pi_Xi2) * std::pow((n - 1) * pi_Xi2, double(k));
-        GraphStatics::divideByFactorial(probability, k);
-        approximateProperties.vertexProbability.push_back(probability);
-    }
+    // Vertex probabilities for every k (0 <= k <= n-1), shared with other graphs of the same parameters.
+    if (metricSet != ALL_METRICS)
+        return;
+
+    std::shared_ptr<const VertexProbabilities> probabilities = DistributionCache::get(n, xi);
+    approximateProperties.vertexProbability = std::shared_ptr<const std::vector<double>>(probabilities, &probabilities->approximate);
 }
 
 template<unsigned int Dim>
-bool Graph<Dim>::checkIfConnected()
+std::vector<unsigned int> Graph<Dim>::breadthFirstSearch(unsigned int rootIndex) const
 {
-    // No vertices, graph is disconnected.
-    if (n == 0)
-        return false;
+    std::vector<unsigned int> distances = std::vector<unsigned int>(n, INF);
+    std::queue<unsigned int> indexQueue;
 
-    // Max probable density - surely connected.
-    if (exactProperties.density == 1.0)
-        return true;
+    distances[rootIndex] = 0;
+    indexQueue.push(rootIndex);
 
-    // Visit every vertex and set its value in the vector to 1...
-    std::vector<unsigned int> indexes = std::vector<unsigned int>(vertices.size(), 0);
-    for (unsigned int i = 0; i < indexes.size(); ++i)
+    while (!indexQueue.empty())
     {
-        if (indexes[i] == 0)
-            visitNode(indexes, i);
-    }
+        unsigned int current = indexQueue.front();
+        indexQueue.pop();
+        auto visit = [&](unsigned int adjacent)
+        {
+            if (distances[adjacent] == INF)
+            {
+                distances[adjacent] = distances[current] + 1;
+                indexQueue.push(adjacent);
+            }
+        };
 
-    // ...if at least one vertex has value 0 (has not been visited), the graph is disconnected.
-    for (auto index : indexes)
-    {
-        if (index == 0)
-            return false;
+        if (snapshot)
+            std::for_each(snapshot->getConnectedVerticesBegin(current), snapshot->getConnectedVerticesEnd(current), visit);
+        else
+        {
+            const std::vector<unsigned int> & indexes = vertices[current].getConnectedVerticesIndexes();
+            std::for_each(indexes.begin(), indexes.end(), visit);
+        }
     }
 
-    return true;
+    return distances;
 }
 
 template<unsigned int Dim>
-void Graph<Dim>::visitNode(std::vector<unsigned int> & indexes, unsigned int index)
+unsigned int Graph<Dim>::getNeighborLinks(unsigned int index) const
 {
-    indexes[index] = 1;
-    for (unsigned int & i : vertices[index].getConnectedVerticesIndexes())
-    {
-        if (indexes[i] == 0)
-            visitNode(indexes, i);
-    }
+    if (useDenseAdjacency)
+        return denseAdjacency.getNeighborLinks(index);
+
+    if (snapshot)
+        return countNeighborLinks(snapshot->getConnectedVerticesBegin(index), snapshot->getConnectedVerticesEnd(index));
+
+    const std::vector<unsigned int> & indexes = vertices[index].getConnectedVerticesIndexes();
+    return countNeighborLinks(indexes.begin(), indexes.end());
 }
 
 template<unsigned int Dim>
-std::vector<unsigned int> Graph<Dim>::breadthFirstSearch(unsigned int rootIndex)
+template<typename IndexIterator>
+unsigned int Graph<Dim>::countNeighborLinks(IndexIterator begin, IndexIterator end) const
 {
-    std::vector<unsigned int> distances = std::vector<unsigned int>(vertices.size(), INF);
-    std::queue<unsigned int> indexQueue;
-
-    distances[rootIndex] = 0;
-    indexQueue.push(rootIndex);
-
-    while (!indexQueue.empty())
+    // For every pair of neighbors (nested loops), check if they are connected.
+    unsigned int links = 0;
+    for (IndexIterator i1 = begin; i1 != end; ++i1)
     {
-        unsigned int current = indexQueue.front();
-        indexQueue.pop();
-        for (auto & adjacent : vertices[current].getConnectedVerticesIndexes())
+        unsigned int index1 = *i1;
+        for (IndexIterator i2 = i1 + 1; i2 != end; ++i2)
         {
-            if (distances[adjacent] == INF)
+            unsigned int index2 = *i2;
+
+            // Neighbor i1 and i2 are connected, if the distance between them is equal or less than xi.
+            if (getDistance(index1, index2) <= xi)
             {
-                distances[adjacent] = distances[current] + 1;
-                indexQueue.push(adjacent);
+                links += 1;
             }
         }
     }
 
-    return distances;
+    return links;
 }
+
+template<unsigned int Dim>
+double Graph<Dim>::getDistance(unsigned int first, unsigned int second) const
+{
+    if (!snapshot)
+        return vertices[first].getDistanceTo(vertices[second]);
+
+    // Same calculation as Vertex::getDistanceTo, so mapped graphs give identical results.
+    double distance = 0.0;
+    for (unsigned int axis = 0; axis < Dim; ++axis)
+    {
+        distance += std::pow((snapshot->getAxisValue(second, axis) - snapshot->getAxisValue(first, axis)), 2.0);
+    }
+
+    return std::sqrt(distance);
+}
+
+template<unsigned int Dim>
+unsigned long long Graph<Dim>::getDistanceSum(unsigned int rootIndex, unsigned int firstIndex) const
+{
+    if (useDenseAdjacency)
+        return denseAdjacency.getDistanceSum(rootIndex, firstIndex);
+
+    unsigned long long distanceSum = 0;
+    auto distances = breadthFirstSearch(rootIndex);
+    for (unsigned int dist = firstIndex; dist < distances.size(); ++dist)
+    {
+        distanceSum += (distances[dist] != INF ? distances[dist] : 0);
+    }
+
+    return distanceSum;
+}
\ No newline at end of file
@@ -0,0 +1,301 @@
+#pragma once
+
+#include "Vertex.h"
+#include "Utilities/MappedFile.h"
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#define SNAPSHOT_MAGIC 0x53484745 // "EGHS" when read as little-endian bytes.
+#define SNAPSHOT_VERSION 2
+
+template<unsigned int Dim>
+class Graph;
+
+/**
+ * Fixed-size header at the beginning of every graph snapshot file. It is followed by vertex coordinates
+ * (n * Dim doubles), adjacency offsets (n + 1 values) and connected vertices indexes (2 * edge count values),
+ * so the adjacency is stored in compressed sparse row layout and can be used directly from the mapped file.
+ */
+struct SnapshotHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t dimensions;
+    uint32_t vertexCount;
+    uint32_t vertexEngine;  // VertexEngine used with the seed to generate the positions.
+    uint32_t reserved;      // Always 0, keeps the following fields (and sections) 8-byte aligned.
+    double xi;
+    uint64_t seed;
+    uint64_t adjacencySize;
+};
+
+/**
+ * Binary snapshot of the graph (vertex positions and edges), memory-mapped for reading, so the stored graphs
+ * can be analysed again without repeating the vertex generation and the edge construction.
+ */
+template<unsigned int Dim>
+class GraphSnapshot
+{
+public:
+    /**
+     * Write the vertices and edges of specified graph to the file. Returns false if the file cannot be written or
+     * the graph does not store its edges (CONNECTIVITY_METRICS).
+     */
+    static bool save(const Graph<Dim> & graph, const std::string & filename);
+
+    /** Map specified snapshot file. Returns false if it cannot be mapped or is not a valid 'Dim' snapshot. */
+    bool open(const std::string & filename);
+
+    /** Unmap the snapshot file. */
+    void close();
+
+    //////////////////////////////////////////////////////////////////////
+    //// Getters
+    //////////////////////////////////////////////////////////////////////
+
+    /** Get number of vertices (n). */
+    unsigned int getVerticesCount() const;
+
+    /** Get the probability of edge between two vertices (xi). */
+    double getEdgeProbability() const;
+
+    /** Get the seed used to generate vertex positions. */
+    unsigned int getSeed() const;
+
+    /** Get the random generator used (with the seed) to generate vertex positions. */
+    VertexEngine getVertexEngine() const;
+
+    /** Get number of edges. */
+    unsigned int getEdgeCount() const;
+
+    /** Return position value of specified vertex for specified axis. */
+    double getAxisValue(unsigned int index, unsigned int axis) const;
+
+    /** Returns number of vertices connected with specified vertex. */
+    unsigned int getDegree(unsigned int index) const;
+
+    /** Return pointer to the first index of vertices connected to specified vertex (valid while mapped). */
+    const uint32_t * getConnectedVerticesBegin(unsigned int index) const;
+
+    /** Return pointer past the last index of vertices connected to specified vertex (valid while mapped). */
+    const uint32_t * getConnectedVerticesEnd(unsigned int index) const;
+
+private:
+    /** Returns true if a file of 'fileSize' bytes holds exactly the sections for the vertex count and adjacency size. */
+    static bool isSizeValid(uint64_t fileSize, uint64_t vertexCount, uint64_t adjacencySize);
+
+    /** Returns true if the offsets are non-decreasing and inside the adjacency, and every index is a valid vertex. */
+    bool isAdjacencyValid() const;
+
+    /** Memory-mapped snapshot file. */
+    MappedFile file;
+
+    /** Pointers to the sections of the mapped file. */
+    const SnapshotHeader * header = nullptr;
+    const double * coordinates = nullptr;
+    const uint64_t * offsets = nullptr;
+    const uint32_t * adjacency = nullptr;
+};
+
+template<unsigned int Dim>
+bool GraphSnapshot<Dim>::save(const Graph<Dim> & graph, const std::string & filename)
+{
+    if (graph.getMetricSet() == CONNECTIVITY_METRICS)
+        return false;
+
+    const unsigned int n = graph.getVerticesCount();
+
+    // Flatten positions and adjacency lists.
+    std::vector<double> coordinates;
+    std::vector<uint64_t> offsets;
+    std::vector<uint32_t> adjacency;
+    coordinates.reserve((size_t)n * Dim);
+    offsets.reserve((size_t)n + 1);
+
+    offsets.push_back(0);
+    for (unsigned int i = 0; i < n; ++i)
+    {
+        for (unsigned int axis = 0; axis < Dim; ++axis)
+        {
+            coordinates.push_back(graph.getVertexAxisValue(i, axis));
+        }
+
+        for (unsigned int index : graph.getConnectedVerticesIndexes(i))
+        {
+            adjacency.push_back(index);
+        }
+        offsets.push_back(adjacency.size());
+    }
+
+    SnapshotHeader header;
+    header.magic = SNAPSHOT_MAGIC;
+    header.version = SNAPSHOT_VERSION;
+    header.dimensions = Dim;
+    header.vertexCount = n;
+    header.vertexEngine = graph.getVertexEngine();
+    header.reserved = 0;
+    header.xi = graph.getEdgeProbability();
+    header.seed = graph.getSeed();
+    header.adjacencySize = adjacency.size();
+
+    std::ofstream stream(filename.c_str(), std::ofstream::binary | std::ofstream::trunc);
+    if (!stream.is_open())
+        return false;
+
+    stream.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    stream.write(reinterpret_cast<const char *>(coordinates.data()), coordinates.size() * sizeof(double));
+    stream.write(reinterpret_cast<const char *>(offsets.data()), offsets.size() * sizeof(uint64_t));
+    stream.write(reinterpret_cast<const char *>(adjacency.data()), adjacency.size() * sizeof(uint32_t));
+
+    return stream.good();
+}
+
+template<unsigned int Dim>
+bool GraphSnapshot<Dim>::open(const std::string & filename)
+{
+    close();
+
+    if (!file.open(filename) || file.getSize() < sizeof(SnapshotHeader))
+    {
+        close();
+        return false;
+    }
+
+    // Validate the header before trusting any of the sizes.
+    header = reinterpret_cast<const SnapshotHeader *>(file.getData());
+    if (header->magic != SNAPSHOT_MAGIC || header->version != SNAPSHOT_VERSION || header->dimensions != Dim ||
+        (header->vertexEngine != SEQUENTIAL_VERTICES && header->vertexEngine != BULK_VERTICES) ||
+        header->vertexCount < 2 || !isSizeValid(file.getSize(), header->vertexCount, header->adjacencySize))
+    {
+        close();
+        return false;
+    }
+
+    // Every section size is a multiple of 8 bytes except the last one, so the sections stay aligned.
+    const char * data = file.getData() + sizeof(SnapshotHeader);
+    coordinates = reinterpret_cast<const double *>(data);
+    data += (size_t)header->vertexCount * Dim * sizeof(double);
+    offsets = reinterpret_cast<const uint64_t *>(data);
+    data += ((size_t)header->vertexCount + 1) * sizeof(uint64_t);
+    adjacency = reinterpret_cast<const uint32_t *>(data);
+
+    if (offsets[0] != 0 || offsets[header->vertexCount] != header->adjacencySize || !isAdjacencyValid())
+    {
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+template<unsigned int Dim>
+void GraphSnapshot<Dim>::close()
+{
+    file.close();
+    header = nullptr;
+    coordinates = nullptr;
+    offsets = nullptr;
+    adjacency = nullptr;
+}
+
+//////////////////////////////////////////////////////////////////////
+//// Getters
+//////////////////////////////////////////////////////////////////////
+
+template<unsigned int Dim>
+unsigned int GraphSnapshot<Dim>::getVerticesCount() const
+{
+    return header ? header->vertexCount : 0;
+}
+
+template<unsigned int Dim>
+double GraphSnapshot<Dim>::getEdgeProbability() const
+{
+    return header ? header->xi : 0.0;
+}
+
+template<unsigned int Dim>
+unsigned int GraphSnapshot<Dim>::getSeed() const
+{
+    return header ? (unsigned int)header->seed : 0;
+}
+
+template<unsigned int Dim>
+VertexEngine GraphSnapshot<Dim>::getVertexEngine() const
+{
+    return header ? (VertexEngine)header->vertexEngine : SEQUENTIAL_VERTICES;
+}
+
+template<unsigned int Dim>
+unsigned int GraphSnapshot<Dim>::getEdgeCount() const
+{
+    return header ? (unsigned int)(header->adjacencySize / 2) : 0;
+}
+
+template<unsigned int Dim>
+double GraphSnapshot<Dim>::getAxisValue(unsigned int index, unsigned int axis) const
+{
+    if (axis < Dim)
+    {
+        return coordinates[(size_t)index * Dim + axis];
+    }
+
+    return 0.0;
+}
+
+template<unsigned int Dim>
+unsigned int GraphSnapshot<Dim>::getDegree(unsigned int index) const
+{
+    return (unsigned int)(offsets[index + 1] - offsets[index]);
+}
+
+template<unsigned int Dim>
+const uint32_t * GraphSnapshot<Dim>::getConnectedVerticesBegin(unsigned int index) const
+{
+    return adjacency + offsets[index];
+}
+
+template<unsigned int Dim>
+const uint32_t * GraphSnapshot<Dim>::getConnectedVerticesEnd(unsigned int index) const
+{
+    return adjacency + offsets[index + 1];
+}
+
+//////////////////////////////////////////////////////////////////////
+//// Helper methods
+//////////////////////////////////////////////////////////////////////
+
+template<unsigned int Dim>
+bool GraphSnapshot<Dim>::isSizeValid(uint64_t fileSize, uint64_t vertexCount, uint64_t adjacencySize)
+{
+    // Vertex count has 32 bits, so the fixed part cannot overflow. The adjacency size comes from the file and could
+    // overflow when multiplied, so the remaining bytes are divided instead.
+    const uint64_t fixedSize = sizeof(SnapshotHeader) +
+        vertexCount * Dim * sizeof(double) +
+        (vertexCount + 1) * sizeof(uint64_t);
+    if (fileSize < fixedSize || (fileSize - fixedSize) % sizeof(uint32_t) != 0)
+        return false;
+
+    return adjacencySize == (fileSize - fixedSize) / sizeof(uint32_t);
+}
+
+template<unsigned int Dim>
+bool GraphSnapshot<Dim>::isAdjacencyValid() const
+{
+    // Getters trust the mapped data, so a corrupted file must not get past open().
+    for (unsigned int i = 0; i < header->vertexCount; ++i)
+    {
+        if (offsets[i] > offsets[i + 1] || offsets[i + 1] > header->adjacencySize)
+            return false;
+    }
+
+    for (uint64_t i = 0; i < header->adjacencySize; ++i)
+    {
+        if (adjacency[i] >= header->vertexCount)
+            return false;
+    }
+
+    return true;
+}
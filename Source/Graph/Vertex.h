@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Utilities/GraphUtilities.h"
+#include <algorithm>
 #include <array>
 #include <sstream>
 
@@ -14,9 +15,15 @@ public:
 	/** Creates positions for specified range. */
 	Vertex(const double minRange, const double maxRange);
 
+	/** Creates vertex at specified position (i.e. read from a graph snapshot). */
+	Vertex(const std::array<double, Dim> & position);
+
 	/** Add new connected vertex to this vertex (via its index) */
 	void addConnectedVertex(unsigned int index);
 
+	/** Sort indexes of connected vertices in ascending order. */
+	void sortConnectedVertices();
+
 	//////////////////////////////////////////////////////////////////////
 	//// Getters
 	//////////////////////////////////////////////////////////////////////
@@ -25,13 +32,13 @@ public:
 	double getAxisValue(unsigned int axis) const;
 
 	/** Return the euclidean distance between this and other vertex. */
-	double getDistanceTo(Vertex<Dim> & other) const;
+	double getDistanceTo(const Vertex<Dim> & other) const;
 
 	/** Returns number of connected vertices with this vertex. */
 	unsigned int getDegree() const;
 
 	/** Return collection of indexes of vertices connected to this vertex. */
-	std::vector<unsigned int> getConnectedVerticesIndexes() const;
+	const std::vector<unsigned int> & getConnectedVerticesIndexes() const;
 
 private:
 	/** Array of values describing vertex position in 'Dim' dimensions. */
@@ -59,12 +66,24 @@ Vertex<Dim>::Vertex(const double minRange, const double maxRange)
 	}
 }
 
+template<unsigned int Dim>
+Vertex<Dim>::Vertex(const std::array<double, Dim> & position)
+	: position(position)
+{
+}
+
 template<unsigned int Dim>
 void Vertex<Dim>::addConnectedVertex(unsigned int index)
 {
 	connectedVerticesIndexes.push_back(index);
 }
 
+template<unsigned int Dim>
+void Vertex<Dim>::sortConnectedVertices()
+{
+	std::sort(connectedVerticesIndexes.begin(), connectedVerticesIndexes.end());
+}
+
 //////////////////////////////////////////////////////////////////////
 //// Getters
 //////////////////////////////////////////////////////////////////////
@@ -81,7 +100,7 @@ double Vertex<Dim>::getAxisValue(unsigned int axis) const
 }
 
 template<unsigned int Dim>
-double Vertex<Dim>::getDistanceTo(Vertex<Dim> & other) const
+double Vertex<Dim>::getDistanceTo(const Vertex<Dim> & other) const
 {
 	double distance = 0.0;
 	for (unsigned int i = 0; i < Dim; ++i)
@@ -99,7 +118,7 @@ unsigned int Vertex<Dim>::getDegree() const
 }
 
 template<unsigned int Dim>
-std::vector<unsigned int> Vertex<Dim>::getConnectedVerticesIndexes() const
+const std::vector<unsigned int> & Vertex<Dim>::getConnectedVerticesIndexes() const
 {
 	return connectedVerticesIndexes;
 }
\ No newline at end of file
@@ -1,13 +1,35 @@
 #include "Graph/AverageGraph.h"
+#include "Validation/EngineValidation.h"
+#include "Benchmark/GraphBenchmark.h"
 #include <iostream>
+#include <string>
 
 #define DIMS 2
 
-int main()
+int main(int argc, char * argv[])
 {
+    // Compare optimized engines with the reference implementation instead of generating data.
+    if (argc > 1 && std::string(argv[1]) == "--validate")
+    {
+        Logger::SetOutput(LogOutput::TO_CONSOLE);
+        return EngineValidation::run() == 0 ? 0 : 1;
+    }
+
+    // Measure construction phases of a single large graph, optionally with specified number of vertices.
+    if (argc > 1 && std::string(argv[1]) == "--benchmark")
+    {
+        Logger::SetOutput(LogOutput::TO_CONSOLE);
+        GraphBenchmark::run(argc > 2 ? (unsigned int)std::stoul(argv[2]) : BENCHMARK_VERTICES, BENCHMARK_AVERAGE_DEGREE);
+        return 0;
+    }
+
     // Prepare files for data.
     Logger::SetOutput(LogOutput::TO_FILE);
-    Logger::SetFilename("dane.txt");
+    if (!Logger::SetFilename("dane.txt"))
+    {
+        std::cout << "Cannot open dane.txt for writing.\n";
+        return 1;
+    }
     AverageGraph<DIMS>::logHeaders();
 
     const unsigned int testSets = 20;
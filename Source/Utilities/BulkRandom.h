@@ -0,0 +1,102 @@
+#pragma once
+
+#include "Utilities/Parallel.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#define BULK_RANDOM_LANES 8
+#define BULK_RANDOM_BLOCK_SIZE 4096
+
+/**
+ * Generator of many uniform doubles at once: BULK_RANDOM_LANES independent xoshiro256+ streams advanced side by side
+ * (plain loops over the lanes, which the compiler turns into vector instructions), with the random bits placed
+ * directly into the mantissa of a double instead of an integer-to-double conversion.
+ */
+class BulkRandom
+{
+public:
+    /** Seed all the lanes from 'seed' and 'stream' (different streams give independent sequences). */
+    BulkRandom(uint64_t seed, uint64_t stream)
+    {
+        // Lane states are initialized with splitmix64, as recommended for xoshiro generators.
+        uint64_t splitState = seed * 0x9E3779B97F4A7C15ULL ^ (stream + 1) * 0xD1B54A32D192ED03ULL;
+        for (unsigned int lane = 0; lane < BULK_RANDOM_LANES; ++lane)
+        {
+            s0[lane] = splitMix(splitState);
+            s1[lane] = splitMix(splitState);
+            s2[lane] = splitMix(splitState);
+            s3[lane] = splitMix(splitState);
+        }
+    }
+
+    /** Fill 'values' with 'count' numbers uniformly distributed in [minRange, maxRange). */
+    void fill(double * values, size_t count, double minRange, double maxRange)
+    {
+        const double range = maxRange - minRange;
+        size_t i = 0;
+        for (; i + BULK_RANDOM_LANES <= count; i += BULK_RANDOM_LANES)
+        {
+            next(values + i, minRange, range);
+        }
+
+        if (i < count)
+        {
+            double rest[BULK_RANDOM_LANES];
+            next(rest, minRange, range);
+            std::memcpy(values + i, rest, (count - i) * sizeof(double));
+        }
+    }
+
+    /**
+     * Fill 'values' with 'count' numbers uniformly distributed in [minRange, maxRange) on 'threadCount' threads.
+     * Every block of BULK_RANDOM_BLOCK_SIZE values has its own stream, so the result does not depend on the threads.
+     */
+    static void fill(double * values, size_t count, double minRange, double maxRange, uint64_t seed, unsigned int threadCount)
+    {
+        const size_t blockCount = (count + BULK_RANDOM_BLOCK_SIZE - 1) / BULK_RANDOM_BLOCK_SIZE;
+        Parallel::forChunks(blockCount, blockCount, threadCount, [&](size_t block, size_t, size_t)
+        {
+            const size_t begin = block * BULK_RANDOM_BLOCK_SIZE;
+            const size_t end = begin + BULK_RANDOM_BLOCK_SIZE < count ? begin + BULK_RANDOM_BLOCK_SIZE : count;
+            BulkRandom(seed, block).fill(values + begin, end - begin, minRange, maxRange);
+        });
+    }
+
+private:
+    /** Write next number of every lane (scaled to the range) to 'values'. */
+    void next(double * values, double minRange, double range)
+    {
+        for (unsigned int lane = 0; lane < BULK_RANDOM_LANES; ++lane)
+        {
+            // Upper 52 bits form the mantissa of a double in [1, 2).
+            const uint64_t bits = 0x3FF0000000000000ULL | ((s0[lane] + s3[lane]) >> 12);
+            double unit;
+            std::memcpy(&unit, &bits, sizeof(unit));
+            values[lane] = minRange + (unit - 1.0) * range;
+
+            const uint64_t t = s1[lane] << 17;
+            s2[lane] ^= s0[lane];
+            s3[lane] ^= s1[lane];
+            s1[lane] ^= s2[lane];
+            s0[lane] ^= s3[lane];
+            s2[lane] ^= t;
+            s3[lane] = (s3[lane] << 45) | (s3[lane] >> 19);
+        }
+    }
+
+    /** Next value of the splitmix64 generator. */
+    static uint64_t splitMix(uint64_t & state)
+    {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    /** State of every lane (stored per word, so the same word of all lanes is contiguous). */
+    uint64_t s0[BULK_RANDOM_LANES];
+    uint64_t s1[BULK_RANDOM_LANES];
+    uint64_t s2[BULK_RANDOM_LANES];
+    uint64_t s3[BULK_RANDOM_LANES];
+};
@@ -0,0 +1,73 @@
+#include "DistributionCache.h"
+#include <cmath>
+
+std::map<std::pair<unsigned int, double>, std::shared_ptr<const VertexProbabilities>> DistributionCache::entries =
+	std::map<std::pair<unsigned int, double>, std::shared_ptr<const VertexProbabilities>>();
+std::mutex DistributionCache::entriesMutex;
+
+std::shared_ptr<const VertexProbabilities> DistributionCache::get(const unsigned int n, const double xi)
+{
+	const std::pair<unsigned int, double> key = std::make_pair(n, xi);
+
+	{
+		std::lock_guard<std::mutex> lock(entriesMutex);
+		auto entry = entries.find(key);
+		if (entry != entries.end())
+			return entry->second;
+	}
+
+	// Calculate outside of the lock, so other parameters are not blocked. If another thread was faster,
+	// its result is kept (both are identical anyway).
+	std::shared_ptr<const VertexProbabilities> probabilities = calculate(n, xi);
+
+	std::lock_guard<std::mutex> lock(entriesMutex);
+	return entries.emplace(key, probabilities).first->second;
+}
+
+void DistributionCache::clear()
+{
+	std::lock_guard<std::mutex> lock(entriesMutex);
+	entries.clear();
+}
+
+std::shared_ptr<const VertexProbabilities> DistributionCache::calculate(const unsigned int n, const double xi)
+{
+	std::shared_ptr<VertexProbabilities> probabilities = std::make_shared<VertexProbabilities>();
+
+	// Common constants.
+	double xi2 = std::pow(xi, 2.0);
+	double pi_Xi2 = PI * xi2;
+	std::vector<unsigned int> binomialCoefficients = GraphStatics::binomialCoefficients(n - 1);
+	std::vector<double> vertexProbabilityDiff;
+
+	// Vertex probabilities for every k (0 <= k <= n-1).
+	for (unsigned int k = 0; k <= n - 1; ++k)
+	{
+		double approximate = std::exp(-1.0 * (n - 1) * pi_Xi2) * std::pow((n - 1) * pi_Xi2, double(k));
+		GraphStatics::divideByFactorial(approximate, k);
+		probabilities->approximate.push_back(approximate);
+
+		double exact = binomialCoefficients[k] *
+			std::pow(pi_Xi2, double(k)) *
+			std::pow(1.0 - pi_Xi2, double(n - 1 - k));
+		probabilities->exact.push_back(exact);
+
+		// Add difference between approximate and exact probability (repeat the last valid one on overflow).
+		double probabilityDiff = exact - approximate;
+		if (std::isnan(probabilityDiff) || !std::isfinite(probabilityDiff))
+			probabilityDiff = vertexProbabilityDiff.empty() ? 0.0 : vertexProbabilityDiff.back();
+
+		vertexProbabilityDiff.push_back(probabilityDiff);
+		probabilities->averageDifference += probabilityDiff;
+	}
+
+	// Calculate variance of differences between exact and approximate vertex probabilities.
+	probabilities->averageDifference /= n;
+	for (unsigned int k = 0; k < n; ++k)
+	{
+		probabilities->differenceVariance += std::pow(vertexProbabilityDiff[k] - probabilities->averageDifference, 2.0);
+	}
+	probabilities->differenceVariance /= n;
+
+	return probabilities;
+}
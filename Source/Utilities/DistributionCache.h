@@ -0,0 +1,46 @@
+#pragma once
+
+#include "Utilities/GraphUtilities.h"
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+/**
+ * Vertex degree distributions which depend only on 'n' and 'xi' (not on the vertex positions),
+ * calculated once and shared by every graph with the same parameters.
+ */
+struct VertexProbabilities
+{
+    /** Poisson approximation of the probability that a vertex has degree k (0 <= k <= n-1). */
+    std::vector<double> approximate;
+
+    /** Binomial probability that a vertex has degree k (0 <= k <= n-1). */
+    std::vector<double> exact;
+
+    /** Average difference between exact and approximate probabilities. */
+    double averageDifference = 0.0;
+
+    /** Variance of the differences between exact and approximate probabilities. */
+    double differenceVariance = 0.0;
+};
+
+/**
+ * Thread-safe cache of vertex probability distributions for every requested ('n', 'xi') pair.
+ */
+class DistributionCache
+{
+public:
+    /** Return distributions for specified parameters, calculating them on the first request. */
+    static std::shared_ptr<const VertexProbabilities> get(const unsigned int n, const double xi);
+
+    /** Remove all cached distributions (graphs still referencing them keep them alive). */
+    static void clear();
+
+private:
+    /** Performs the calculations of both distributions and their differences. */
+    static std::shared_ptr<const VertexProbabilities> calculate(const unsigned int n, const double xi);
+
+    static std::map<std::pair<unsigned int, double>, std::shared_ptr<const VertexProbabilities>> entries;
+    static std::mutex entriesMutex;
+};
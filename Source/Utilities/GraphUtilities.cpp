@@ -20,6 +20,58 @@ double GraphStatics::getRandomPosition(const double minRange, const double maxRa
 	return distributions[dimension](randomNumberGenerators[dimension]);
 }
 
+void GraphStatics::seedRandomGenerators(const unsigned int seed, const unsigned int dimensions)
+{
+	while (dimensions > randomNumberGenerators.size())
+		randomNumberGenerators.push_back(std::mt19937());
+
+	// Every dimension gets a different sequence derived from the same seed.
+	for (unsigned int i = 0; i < dimensions; ++i)
+	{
+		std::seed_seq sequence = { seed, i };
+		randomNumberGenerators[i].seed(sequence);
+	}
+
+	for (auto & distribution : distributions)
+		distribution.reset();
+}
+
+unsigned int GraphStatics::getRandomSeed()
+{
+	unsigned int seed = RANDOM_SEED;
+	while (seed == RANDOM_SEED)
+		seed = std::random_device()();
+
+	return seed;
+}
+
+uint64_t GraphStatics::getMortonKey(const double * position, const unsigned int dimensions, const double minRange, const double maxRange)
+{
+	assert(dimensions > 0 && dimensions <= 64);
+
+	// Quantize every coordinate to the same number of bits, so the interleaved key fits into 64 bits.
+	const unsigned int bitsPerAxis = min(21, 64 / dimensions);
+	const double cells = double(1ULL << bitsPerAxis);
+	uint64_t cellIndexes[64];
+	for (unsigned int axis = 0; axis < dimensions; ++axis)
+	{
+		double cell = std::floor((position[axis] - minRange) / (maxRange - minRange) * cells);
+		cellIndexes[axis] = cell <= 0.0 ? 0 : (cell >= cells ? (1ULL << bitsPerAxis) - 1 : (uint64_t)cell);
+	}
+
+	// Interleave bits from the most significant one (Z-order).
+	uint64_t key = 0;
+	for (unsigned int bit = bitsPerAxis; bit-- > 0;)
+	{
+		for (unsigned int axis = 0; axis < dimensions; ++axis)
+		{
+			key = (key << 1) | ((cellIndexes[axis] >> bit) & 1);
+		}
+	}
+
+	return key;
+}
+
 unsigned long long GraphStatics::factorial(unsigned long long n)
 {
 	return (n == 1 || n == 0) ? 1 : factorial(n - 1) * n;
@@ -51,6 +103,23 @@ unsigned int GraphStatics::binomialCoefficient(unsigned int n, unsigned int k)
 	return C[n][k];
 }
 
+std::vector<unsigned int> GraphStatics::binomialCoefficients(unsigned int n)
+{
+	// Single row of Pascal's triangle built in place, so C(n, k) for every k costs O(n^2) instead of O(n^3).
+	std::vector<unsigned int> C = std::vector<unsigned int>(n + 1, 0);
+	C[0] = 1;
+
+	for (unsigned int i = 1; i <= n; i++)
+	{
+		for (unsigned int j = i; j >= 1; j--)
+		{
+			C[j] += C[j - 1];
+		}
+	}
+
+	return C;
+}
+
 unsigned int GraphStatics::min(unsigned int a, unsigned int b)
 {
 	return a < b ? a : b;
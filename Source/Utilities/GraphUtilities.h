@@ -5,10 +5,83 @@
 #define DEFAULT_MIN_RANGE 0.0
 #define DEFAULT_MAX_RANGE 1.0
 #define INF 1000000
+#define RANDOM_SEED 0
+#define DENSE_DENSITY_THRESHOLD 0.1
 
 #include "Utilities/Utilities.h"
+#include <cstdint>
+#include <memory>
 #include <random>
 
+/**
+ * Representation of the edges used to calculate the exact properties.
+ */
+enum AdjacencyEngine
+{
+    AUTO_ADJACENCY,     // Dense above DENSE_DENSITY_THRESHOLD of expected density, sparse otherwise.
+    SPARSE_ADJACENCY,   // Lists of connected vertices indexes kept in every vertex.
+    DENSE_ADJACENCY     // n x n bit matrix.
+};
+
+/**
+ * Method used to find pairs of vertices which are not further from each other than xi.
+ */
+enum EdgeEngine
+{
+    BRUTE_FORCE_EDGES,  // Every pair of vertices is checked.
+    GRID_EDGES          // Vertices are bucketed into cells of size >= xi, only adjacent cells are checked.
+};
+
+/**
+ * Random generator used to create the vertex positions (the same seed gives different positions in every engine).
+ */
+enum VertexEngine
+{
+    SEQUENTIAL_VERTICES,    // One std::mt19937 per dimension, vertex by vertex.
+    BULK_VERTICES           // All coordinates at once with multi-lane xoshiro256+ (see BulkRandom).
+};
+
+/**
+ * Set of exact properties calculated for the graph.
+ */
+enum MetricSet
+{
+    ALL_METRICS,            // Every exact property.
+    EDGE_METRICS,           // Edges are stored, but only edge count, average degree, density and components are
+                            // calculated (no clustering, path lengths and vertex probabilities).
+    CONNECTIVITY_METRICS    // Only connectivity and components. Edges are not stored (so the graph cannot be saved
+                            // as a snapshot) and their generation stops as soon as the graph is connected. Other exact
+                            // properties and the vertex probabilities (O(n^2) for every 'n' and 'xi') are left at
+                            // their defaults.
+};
+
+/**
+ * Parameters controlling how the graph is generated and analysed (apart from 'vertexEngine' and 'metricSet' they do
+ * not change the calculated properties).
+ */
+struct GraphOptions
+{
+    unsigned int seed = RANDOM_SEED;
+    AdjacencyEngine adjacencyEngine = AUTO_ADJACENCY;
+    EdgeEngine edgeEngine = BRUTE_FORCE_EDGES;
+    VertexEngine vertexEngine = SEQUENTIAL_VERTICES;
+    MetricSet metricSet = ALL_METRICS;
+    bool reorderVertices = false;  // Sort vertices along Morton curve before building the edges.
+    unsigned int threadCount = 1;  // Threads used inside a single graph (0 uses all hardware threads).
+    bool measurePhases = false;    // Record time of every construction phase (see PhaseTimes).
+};
+
+/**
+ * Time in seconds spent in every phase of the graph construction (recorded with GraphOptions::measurePhases).
+ */
+struct PhaseTimes
+{
+    double generation = 0.0;
+    double reordering = 0.0;
+    double edges = 0.0;
+    double exactProperties = 0.0;
+};
+
 /**
  * Properties calculated approximately and may be very inaccurate in some marginal cases.
  */
@@ -17,7 +90,8 @@ struct ApproximateProperties
     double expectedValueOfDegree = 0.0;
     double expectedValueOfEdgeCount = 0.0;
     double averageDensity = 0.0;
-    std::vector<double> vertexProbability;
+    /** Probability of vertex degree k (0 <= k <= n-1), shared by all graphs with the same 'n' and 'xi'. */
+    std::shared_ptr<const std::vector<double>> vertexProbability;
 };
 
 /**
@@ -30,8 +104,11 @@ struct ExactProperties
     double density = 0.0;
     double averagePathLength = 0.0;
     double groupingFactor = 0.0;
-    std::vector<double> vertexProbability;
+    /** Probability of vertex degree k (0 <= k <= n-1), shared by all graphs with the same 'n' and 'xi'. */
+    std::shared_ptr<const std::vector<double>> vertexProbability;
     bool isConnected = false;
+    unsigned int componentCount = 0;
+    unsigned int largestComponentSize = 0;
     double degreeVariance = 0.0;
     double normalizedDegreeVariance = 0.0;
     double averageVertexProbability = 0.0;
@@ -66,8 +143,12 @@ class GraphStatics
 {
 public:
     static double getRandomPosition(const double minRange, const double maxRange, const unsigned int dimension);
+    static void seedRandomGenerators(const unsigned int seed, const unsigned int dimensions);
+    static unsigned int getRandomSeed();
+    static uint64_t getMortonKey(const double * position, const unsigned int dimensions, const double minRange, const double maxRange);
     static unsigned long long factorial(unsigned long long n);
     static unsigned int binomialCoefficient(unsigned int n, unsigned int k);
+    static std::vector<unsigned int> binomialCoefficients(unsigned int n);
     static unsigned int min(unsigned int a, unsigned int b);
     static void divideByFactorial(double & value, unsigned int factor);
 
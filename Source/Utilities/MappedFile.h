@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+/**
+ * Read-only memory mapping of a whole file (POSIX mmap or Windows file mapping).
+ */
+class MappedFile
+{
+public:
+    MappedFile()
+    {};
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile & operator=(const MappedFile &) = delete;
+
+    /** Map specified file into memory. Returns false if the file cannot be opened or mapped. */
+    bool open(const std::string & filename);
+
+    /** Unmap the file (safe to call when nothing is mapped). */
+    void close();
+
+    /** Return pointer to the first byte of the mapped file or nullptr if nothing is mapped. */
+    const char * getData() const;
+
+    /** Return size of the mapped file in bytes. */
+    size_t getSize() const;
+
+private:
+    const char * data = nullptr;
+    size_t size = 0;
+
+#ifdef _WIN32
+    void * fileHandle = nullptr;
+    void * mappingHandle = nullptr;
+#endif
+};
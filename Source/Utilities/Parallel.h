@@ -0,0 +1,59 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+#define PARALLEL_CHUNKS_PER_THREAD 16
+
+/**
+ * Minimal helpers for splitting loops over vertices between threads.
+ */
+class Parallel
+{
+public:
+    /** Returns number of threads to use for requested count (0 means all hardware threads). */
+    static unsigned int getThreadCount(unsigned int requested)
+    {
+        if (requested > 0)
+            return requested;
+
+        unsigned int hardwareThreads = std::thread::hardware_concurrency();
+        return hardwareThreads > 0 ? hardwareThreads : 1;
+    }
+
+    /**
+     * Splits [0, count) into 'chunkCount' contiguous chunks and calls 'function(chunk, begin, end)' for each of them
+     * on up to 'threadCount' threads. Chunks are taken dynamically, so any result depending on the order has to be
+     * stored per chunk and combined in chunk order afterwards. With a single thread everything runs on the caller.
+     */
+    template<typename Function>
+    static void forChunks(size_t count, size_t chunkCount, unsigned int threadCount, Function function)
+    {
+        chunkCount = std::max<size_t>(1, std::min(chunkCount, count));
+        auto getChunkBegin = [&](size_t chunk) { return count * chunk / chunkCount; };
+
+        std::atomic<size_t> nextChunk(0);
+        auto worker = [&]()
+        {
+            for (size_t chunk = nextChunk++; chunk < chunkCount; chunk = nextChunk++)
+            {
+                function(chunk, getChunkBegin(chunk), getChunkBegin(chunk + 1));
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (unsigned int i = 1; i < std::min<size_t>(threadCount, chunkCount); ++i)
+        {
+            threads.push_back(std::thread(worker));
+        }
+
+        worker();
+        for (auto & thread : threads)
+        {
+            thread.join();
+        }
+    }
+};
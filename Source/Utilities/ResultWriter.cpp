@@ -0,0 +1,145 @@
+#include "ResultWriter.h"
+
+#include <charconv>
+
+ResultWriter::~ResultWriter()
+{
+	close();
+}
+
+bool ResultWriter::open(const std::string & filename)
+{
+	close();
+
+	file.open(filename.c_str(), std::ofstream::trunc);
+	if (!file.is_open())
+		return false;
+
+	// Preallocate all the buffers, so no memory is allocated while writing.
+	currentBuffer.reserve(RESULT_BUFFER_SIZE);
+	freeBuffers.clear();
+	for (unsigned int i = 1; i < RESULT_BUFFER_COUNT; ++i)
+	{
+		freeBuffers.push_back(std::vector<char>());
+		freeBuffers.back().reserve(RESULT_BUFFER_SIZE);
+	}
+
+	isWriting = true;
+	writerThread = std::thread(&ResultWriter::writeBuffers, this);
+
+	return true;
+}
+
+void ResultWriter::close()
+{
+	if (!writerThread.joinable())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(buffersMutex);
+		if (!currentBuffer.empty())
+			filledBuffers.push_back(std::move(currentBuffer));
+
+		isWriting = false;
+	}
+	filledCondition.notify_one();
+	freeCondition.notify_all();
+
+	writerThread.join();
+	file.close();
+
+	currentBuffer = std::vector<char>();
+	freeBuffers.clear();
+}
+
+bool ResultWriter::isOpen() const
+{
+	return file.is_open();
+}
+
+void ResultWriter::write(const char * text, size_t length)
+{
+	getRow().append(text, length);
+}
+
+void ResultWriter::write(double number)
+{
+	// Same output as std::fixed << std::setprecision(RESULT_DOUBLE_PRECISION).
+	char digits[512];
+	std::to_chars_result result = std::to_chars(digits, digits + sizeof(digits), number, std::chars_format::fixed, RESULT_DOUBLE_PRECISION);
+	getRow().append(digits, result.ptr);
+}
+
+void ResultWriter::write(unsigned int number)
+{
+	char digits[16];
+	std::to_chars_result result = std::to_chars(digits, digits + sizeof(digits), number);
+	getRow().append(digits, result.ptr);
+}
+
+void ResultWriter::write(int number)
+{
+	char digits[16];
+	std::to_chars_result result = std::to_chars(digits, digits + sizeof(digits), number);
+	getRow().append(digits, result.ptr);
+}
+
+void ResultWriter::endRow()
+{
+	std::string & row = getRow();
+	row.push_back('\n');
+
+	{
+		std::unique_lock<std::mutex> lock(buffersMutex);
+
+		// Hand the full buffer to the writer thread and continue with a free one (wait if all are still queued).
+		if (isWriting && !currentBuffer.empty() && currentBuffer.size() + row.size() > RESULT_BUFFER_SIZE)
+		{
+			filledBuffers.push_back(std::move(currentBuffer));
+			filledCondition.notify_one();
+
+			freeCondition.wait(lock, [this]() { return !freeBuffers.empty() || !isWriting; });
+			if (isWriting)
+			{
+				currentBuffer = std::move(freeBuffers.back());
+				freeBuffers.pop_back();
+			}
+		}
+
+		// Without the writer thread (file not opened or already closed) nobody would ever empty the buffers.
+		if (isWriting)
+			currentBuffer.insert(currentBuffer.end(), row.begin(), row.end());
+	}
+
+	row.clear();
+}
+
+void ResultWriter::writeBuffers()
+{
+	std::unique_lock<std::mutex> lock(buffersMutex);
+	while (true)
+	{
+		filledCondition.wait(lock, [this]() { return !filledBuffers.empty() || !isWriting; });
+		if (filledBuffers.empty())
+			return;
+
+		std::vector<char> buffer = std::move(filledBuffers.front());
+		filledBuffers.pop_front();
+
+		// Write without holding the lock, so other threads can keep adding rows.
+		lock.unlock();
+		file.write(buffer.data(), buffer.size());
+		buffer.clear();
+		lock.lock();
+
+		freeBuffers.push_back(std::move(buffer));
+		freeCondition.notify_one();
+	}
+}
+
+std::string & ResultWriter::getRow()
+{
+	// Capacity is kept between rows, so after the first few rows no memory is allocated.
+	thread_local std::string row;
+	return row;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define RESULT_BUFFER_SIZE (1 << 16)
+#define RESULT_BUFFER_COUNT 4
+#define RESULT_DOUBLE_PRECISION 9
+
+/**
+ * Buffered file output written on a background thread. Every calling thread builds its current row in its own
+ * (reused) row buffer, numbers are formatted with std::to_chars, and only complete rows are copied into the shared
+ * buffer, so rows from many threads never interleave. Full buffers are handed to the writer thread and reused
+ * afterwards, so the compute threads do not wait for the disk or allocate memory for the output.
+ */
+class ResultWriter
+{
+public:
+	ResultWriter()
+	{};
+
+	~ResultWriter();
+
+	ResultWriter(const ResultWriter &) = delete;
+	ResultWriter & operator=(const ResultWriter &) = delete;
+
+	/** Open (truncate) the file and start the writer thread. Returns false if the file cannot be opened. */
+	bool open(const std::string & filename);
+
+	/** Write all complete rows, stop the writer thread and close the file. */
+	void close();
+
+	/** Returns true if the file is open. */
+	bool isOpen() const;
+
+	/** Append text to the row of the calling thread. */
+	void write(const char * text, size_t length);
+
+	/** Append number to the row of the calling thread (fixed notation, RESULT_DOUBLE_PRECISION digits). */
+	void write(double number);
+
+	/** Append number to the row of the calling thread. */
+	void write(unsigned int number);
+
+	/** Append number to the row of the calling thread. */
+	void write(int number);
+
+	/**
+	 * Finish the row of the calling thread (adds new line) and pass it to the shared buffer.
+	 * The row is dropped if the writer is not open.
+	 */
+	void endRow();
+
+private:
+	/** Loop of the writer thread: write filled buffers to the file and return them to the free ones. */
+	void writeBuffers();
+
+	/** Returns the row buffer of the calling thread. */
+	static std::string & getRow();
+
+	std::ofstream file;
+	std::thread writerThread;
+
+	/** Guards the flag and all the buffers below. */
+	std::mutex buffersMutex;
+	std::condition_variable filledCondition;
+	std::condition_variable freeCondition;
+
+	/** True between open and close, while the writer thread accepts rows. */
+	bool isWriting = false;
+
+	/** Buffer currently filled with complete rows. */
+	std::vector<char> currentBuffer;
+
+	/** Buffers waiting for the writer thread. */
+	std::deque<std::vector<char>> filledBuffers;
+
+	/** Buffers already written, ready to be reused. */
+	std::vector<std::vector<char>> freeBuffers;
+};
@@ -1,18 +1,35 @@
 #include "Utilities.h"
 
+#include <cstring>
 #include <iostream>
 #include <iomanip>
 
 std::string Logger::Filename = "";
 LogOutput Logger::Output = LogOutput::TO_CONSOLE;
-std::ofstream Logger::FileStream = std::ofstream();
+ResultWriter Logger::FileWriter;
 
-void Logger::Log(std::string text, bool addNewLine)
+void Logger::Log(const std::string & text, bool addNewLine)
 {
 	if (Output == TO_CONSOLE)
 		std::cout << text << (addNewLine ? "\n" : "");
 	else if (Output == TO_FILE)
-		FileStream << text << (addNewLine ? "\n" : "");
+	{
+		FileWriter.write(text.data(), text.size());
+		if (addNewLine)
+			FileWriter.endRow();
+	}
+}
+
+void Logger::Log(const char * text, bool addNewLine)
+{
+	if (Output == TO_CONSOLE)
+		std::cout << text << (addNewLine ? "\n" : "");
+	else if (Output == TO_FILE)
+	{
+		FileWriter.write(text, std::strlen(text));
+		if (addNewLine)
+			FileWriter.endRow();
+	}
 }
 
 void Logger::Log(double number, bool addNewLine)
@@ -20,7 +37,11 @@ void Logger::Log(double number, bool addNewLine)
 	if (Output == TO_CONSOLE)
 		std::cout << std::fixed << std::setprecision(9) << number << (addNewLine ? "\n" : "");
 	else if (Output == TO_FILE)
-		FileStream << std::fixed << std::setprecision(9) << number << (addNewLine ? "\n" : "");
+	{
+		FileWriter.write(number);
+		if (addNewLine)
+			FileWriter.endRow();
+	}
 }
 
 void Logger::Log(unsigned int number, bool addNewLine)
@@ -28,7 +49,11 @@ void Logger::Log(unsigned int number, bool addNewLine)
 	if (Output == TO_CONSOLE)
 		std::cout << number << (addNewLine ? "\n" : "");
 	else if (Output == TO_FILE)
-		FileStream << number << (addNewLine ? "\n" : "");
+	{
+		FileWriter.write(number);
+		if (addNewLine)
+			FileWriter.endRow();
+	}
 }
 
 void Logger::Log(int number, bool addNewLine)
@@ -36,14 +61,17 @@ void Logger::Log(int number, bool addNewLine)
 	if (Output == TO_CONSOLE)
 		std::cout << number << (addNewLine ? "\n" : "");
 	else if (Output == TO_FILE)
-		FileStream << number << (addNewLine ? "\n" : "");
+	{
+		FileWriter.write(number);
+		if (addNewLine)
+			FileWriter.endRow();
+	}
 }
 
-void Logger::SetFilename(std::string filename)
+bool Logger::SetFilename(std::string filename)
 {
 	Filename = filename;
-	//FileStream.open(filename.c_str(), std::ofstream::app);
-	FileStream.open(filename.c_str());
+	return FileWriter.open(filename);
 }
 
 void Logger::SetOutput(LogOutput output)
@@ -53,6 +81,6 @@ void Logger::SetOutput(LogOutput output)
 
 void Logger::CloseStream()
 {
-	if (FileStream.is_open())
-		FileStream.close();
+	if (FileWriter.isOpen())
+		FileWriter.close();
 }
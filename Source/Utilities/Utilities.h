@@ -5,9 +5,8 @@
 #define LOG_DELIMITED(TEXT, DELIMITER) Logger::Log(TEXT, false); Logger::Log(DELIMITER, false)
 #define LOG_DELIMITED_DEFAULT(TEXT) LOG_DELIMITED(TEXT, DEFAULT_DELIMITER)
 
-#include "Utilities/Utilities.h"
+#include "Utilities/ResultWriter.h"
 #include <string>
-#include <fstream>
 
 enum LogOutput
 {
@@ -19,16 +18,18 @@ enum LogOutput
 class Logger
 {
 public:
-	static void Log(std::string text, bool addNewLine = true);
+	static void Log(const std::string & text, bool addNewLine = true);
+	static void Log(const char * text, bool addNewLine = true);
 	static void Log(double number, bool addNewLine = true);
 	static void Log(int number, bool addNewLine = true);
 	static void Log(unsigned int number, bool addNewLine = true);
 
-	static void SetFilename(std::string filename);
+	/** Open the file for TO_FILE output. Returns false if the file cannot be opened. */
+	static bool SetFilename(std::string filename);
 	static void SetOutput(LogOutput output);
 	static void CloseStream();
 private:
 	static std::string Filename;
 	static LogOutput Output;
-	static std::ofstream FileStream;
+	static ResultWriter FileWriter;
 };
@@ -0,0 +1,202 @@
+#include "EngineValidation.h"
+#include <chrono>
+#include <cmath>
+#include <sstream>
+
+unsigned int EngineValidation::run()
+{
+	auto start = std::chrono::steady_clock::now();
+	std::mt19937 random(VALIDATION_SEED);
+
+	unsigned int mismatches = 0;
+	mismatches += runCases<1>(random);
+	mismatches += runCases<2>(random);
+	mismatches += runCases<3>(random);
+
+	std::remove(VALIDATION_SNAPSHOT_FILE);
+
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	std::ostringstream summary;
+	summary << "Validation " << (mismatches == 0 ? "passed" : "FAILED") << ": " << mismatches << " mismatches, "
+		<< getEngines().size() << " engines, " << seconds << " s.";
+	LOG(summary.str());
+
+	return mismatches;
+}
+
+std::vector<ValidationEngine> EngineValidation::getEngines()
+{
+	std::vector<ValidationEngine> engines;
+
+	// Default options, as used by the main program (dense or sparse chosen by the expected density).
+	ValidationEngine automatic;
+	automatic.name = "automatic adjacency";
+	automatic.options.adjacencyEngine = AUTO_ADJACENCY;
+	engines.push_back(automatic);
+
+	ValidationEngine dense;
+	dense.name = "dense adjacency";
+	dense.options.adjacencyEngine = DENSE_ADJACENCY;
+	engines.push_back(dense);
+
+	ValidationEngine grid;
+	grid.name = "grid edges";
+	grid.options.adjacencyEngine = SPARSE_ADJACENCY;
+	grid.options.edgeEngine = GRID_EDGES;
+	engines.push_back(grid);
+
+	ValidationEngine denseGrid;
+	denseGrid.name = "grid edges (dense)";
+	denseGrid.options.adjacencyEngine = DENSE_ADJACENCY;
+	denseGrid.options.edgeEngine = GRID_EDGES;
+	engines.push_back(denseGrid);
+
+	ValidationEngine reordered;
+	reordered.name = "Morton order";
+	reordered.options.adjacencyEngine = SPARSE_ADJACENCY;
+	reordered.options.reorderVertices = true;
+	engines.push_back(reordered);
+
+	ValidationEngine reorderedGrid;
+	reorderedGrid.name = "Morton order + grid edges";
+	reorderedGrid.options.adjacencyEngine = SPARSE_ADJACENCY;
+	reorderedGrid.options.edgeEngine = GRID_EDGES;
+	reorderedGrid.options.reorderVertices = true;
+	engines.push_back(reorderedGrid);
+
+	ValidationEngine parallel;
+	parallel.name = "parallel (3 threads)";
+	parallel.options.adjacencyEngine = SPARSE_ADJACENCY;
+	parallel.options.threadCount = 3;
+	engines.push_back(parallel);
+
+	ValidationEngine parallelGrid;
+	parallelGrid.name = "parallel grid edges (4 threads)";
+	parallelGrid.options.adjacencyEngine = SPARSE_ADJACENCY;
+	parallelGrid.options.edgeEngine = GRID_EDGES;
+	parallelGrid.options.threadCount = 4;
+	engines.push_back(parallelGrid);
+
+	ValidationEngine parallelDense;
+	parallelDense.name = "parallel dense grid edges (4 threads)";
+	parallelDense.options.adjacencyEngine = DENSE_ADJACENCY;
+	parallelDense.options.edgeEngine = GRID_EDGES;
+	parallelDense.options.threadCount = 4;
+	engines.push_back(parallelDense);
+
+	ValidationEngine bulk;
+	bulk.name = "bulk vertices + grid edges";
+	bulk.options.adjacencyEngine = SPARSE_ADJACENCY;
+	bulk.options.edgeEngine = GRID_EDGES;
+	bulk.options.vertexEngine = BULK_VERTICES;
+	engines.push_back(bulk);
+
+	ValidationEngine parallelBulk;
+	parallelBulk.name = "bulk vertices + parallel dense grid edges (4 threads)";
+	parallelBulk.options.adjacencyEngine = DENSE_ADJACENCY;
+	parallelBulk.options.edgeEngine = GRID_EDGES;
+	parallelBulk.options.vertexEngine = BULK_VERTICES;
+	parallelBulk.options.threadCount = 4;
+	engines.push_back(parallelBulk);
+
+	ValidationEngine edgesOnly;
+	edgesOnly.name = "edge metrics only (Morton order + grid edges)";
+	edgesOnly.options.adjacencyEngine = SPARSE_ADJACENCY;
+	edgesOnly.options.edgeEngine = GRID_EDGES;
+	edgesOnly.options.reorderVertices = true;
+	edgesOnly.options.metricSet = EDGE_METRICS;
+	engines.push_back(edgesOnly);
+
+	ValidationEngine connectivity;
+	connectivity.name = "connectivity only";
+	connectivity.options.edgeEngine = GRID_EDGES;
+	connectivity.options.metricSet = CONNECTIVITY_METRICS;
+	engines.push_back(connectivity);
+
+	ValidationEngine parallelConnectivity;
+	parallelConnectivity.name = "connectivity only (3 threads)";
+	parallelConnectivity.options.metricSet = CONNECTIVITY_METRICS;
+	parallelConnectivity.options.threadCount = 3;
+	engines.push_back(parallelConnectivity);
+
+	// Snapshot graphs are analysed on the mapped adjacency, whatever the adjacency engine.
+	ValidationEngine snapshot;
+	snapshot.name = "snapshot reload";
+	snapshot.useSnapshot = true;
+	engines.push_back(snapshot);
+
+	ValidationEngine bulkSnapshot;
+	bulkSnapshot.name = "snapshot reload (bulk vertices)";
+	bulkSnapshot.options.vertexEngine = BULK_VERTICES;
+	bulkSnapshot.useSnapshot = true;
+	engines.push_back(bulkSnapshot);
+
+	ValidationEngine parallelSnapshot;
+	parallelSnapshot.name = "snapshot reload (3 threads)";
+	parallelSnapshot.options.threadCount = 3;
+	parallelSnapshot.useSnapshot = true;
+	engines.push_back(parallelSnapshot);
+
+	return engines;
+}
+
+bool EngineValidation::isClose(double first, double second)
+{
+	// Equal values (including infinities of the same sign) are always close.
+	if (first == second)
+		return true;
+
+	if (std::isnan(first) || std::isnan(second))
+		return std::isnan(first) && std::isnan(second);
+
+	double scale = std::fmax(1.0, std::fmax(std::fabs(first), std::fabs(second)));
+	return std::fabs(first - second) <= VALIDATION_TOLERANCE * scale;
+}
+
+VertexProbabilities EngineValidation::calculateProbabilities(unsigned int n, double xi)
+{
+	VertexProbabilities probabilities;
+	double xi2 = std::pow(xi, 2.0);
+	double pi_Xi2 = PI * xi2;
+	std::vector<double> vertexProbabilityDiff;
+
+	// Every coefficient is calculated on its own (as in the original implementation), not from a shared row.
+	for (unsigned int k = 0; k <= n - 1; ++k)
+	{
+		double approximate = std::exp(-1.0 * (n - 1) * pi_Xi2) * std::pow((n - 1) * pi_Xi2, double(k));
+		GraphStatics::divideByFactorial(approximate, k);
+		probabilities.approximate.push_back(approximate);
+
+		double exact = GraphStatics::binomialCoefficient(n - 1, k) *
+			std::pow(pi_Xi2, double(k)) *
+			std::pow(1.0 - pi_Xi2, double(n - 1 - k));
+		probabilities.exact.push_back(exact);
+
+		double probabilityDiff = exact - approximate;
+		if (!std::isnan(probabilityDiff) && std::isfinite(probabilityDiff))
+			vertexProbabilityDiff.push_back(probabilityDiff);
+		else
+			vertexProbabilityDiff.push_back(vertexProbabilityDiff.empty() ? 0.0 : vertexProbabilityDiff.back());
+
+		probabilities.averageDifference += vertexProbabilityDiff.back();
+	}
+
+	probabilities.averageDifference /= n;
+	for (unsigned int k = 0; k < n; ++k)
+	{
+		probabilities.differenceVariance += std::pow(vertexProbabilityDiff[k] - probabilities.averageDifference, 2.0);
+	}
+	probabilities.differenceVariance /= n;
+
+	return probabilities;
+}
+
+void EngineValidation::logMismatch(const std::string & engine, unsigned int dimensions, unsigned int n, double xi,
+	unsigned int seed, const std::string & property, double expected, double actual)
+{
+	std::ostringstream message;
+	message.precision(17);
+	message << "Mismatch [" << engine << "] Dim=" << dimensions << " n=" << n << " xi=" << xi << " seed=" << seed
+		<< ": " << property << " expected " << expected << ", got " << actual;
+	LOG(message.str());
+}
@@ -0,0 +1,351 @@
+#pragma once
+
+#include "Graph/Graph.h"
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#define VALIDATION_SEED 20160519
+#define VALIDATION_RANDOM_CASES 40
+#define VALIDATION_MAX_VERTICES 256
+#define VALIDATION_TOLERANCE 1e-9
+#define VALIDATION_SNAPSHOT_FILE "validation.snapshot"
+
+/**
+ * Alternative way of building the graph, checked against the reference (brute-force edges, sparse adjacency) built
+ * from the vertices of the same engine.
+ */
+struct ValidationEngine
+{
+    std::string name;
+    GraphOptions options;
+    bool useSnapshot = false;
+};
+
+/**
+ * Differential validation of the optimized engines. The same seeded point sets are built with the reference
+ * options and with every alternative engine, and all exact properties are compared (integer metrics exactly,
+ * floating point ones within tolerance). The set of cases is fixed, so the run time is bounded.
+ */
+class EngineValidation
+{
+public:
+    /** Run all cases for 1, 2 and 3 dimensions. Returns number of mismatches (0 if every engine agrees). */
+    static unsigned int run();
+
+private:
+    /** Returns all engines compared with the reference. */
+    static std::vector<ValidationEngine> getEngines();
+
+    /** Returns true if the values are equal within the tolerance (relative for large values). */
+    static bool isClose(double first, double second);
+
+    /** Log a single mismatch. */
+    static void logMismatch(const std::string & engine, unsigned int dimensions, unsigned int n, double xi,
+        unsigned int seed, const std::string & property, double expected, double actual);
+
+    /** Build and compare graphs for every case (fixed edge cases and random ones) in 'Dim' dimensions. */
+    template<unsigned int Dim>
+    static unsigned int runCases(std::mt19937 & random);
+
+    /** Build the graph with every engine and compare it with the reference. Returns number of mismatches. */
+    template<unsigned int Dim>
+    static unsigned int validateCase(unsigned int n, double xi, unsigned int seed);
+
+    /** Compare properties of the reference and candidate graphs (only the ones in engine's metric set). Returns number of mismatches. */
+    template<unsigned int Dim>
+    static unsigned int compare(const Graph<Dim> & reference, const Graph<Dim> & candidate, const ValidationEngine & engine);
+
+    /** Compare every value of the vertex probability distributions (within tolerance). Returns number of mismatches. */
+    template<unsigned int Dim>
+    static unsigned int compareProbabilities(const std::vector<double> * expected, const std::vector<double> * actual,
+        const std::string & property, const std::string & engine, const Graph<Dim> & reference);
+
+    /** Returns vertex probability distributions calculated with the per-k formulas, independently of DistributionCache. */
+    static VertexProbabilities calculateProbabilities(unsigned int n, double xi);
+
+    /** Compare vertex probabilities of the graph with the independently calculated ones. Returns number of mismatches. */
+    template<unsigned int Dim>
+    static unsigned int checkProbabilities(const Graph<Dim> & graph, const VertexProbabilities & probabilities);
+
+    /** Compare connectivity of the graph with components labeled by breadth-first search. Returns number of mismatches. */
+    template<unsigned int Dim>
+    static unsigned int checkComponents(const Graph<Dim> & graph);
+
+    /** Returns sorted degrees of all vertices (independent of the vertex order). */
+    template<unsigned int Dim>
+    static std::vector<unsigned int> getDegreeSequence(const Graph<Dim> & graph);
+};
+
+template<unsigned int Dim>
+unsigned int EngineValidation::runCases(std::mt19937 & random)
+{
+    unsigned int mismatches = 0;
+
+    // Edge cases: smallest graphs, word boundaries of the bit matrix, no edges (xi = 0), complete graphs.
+    const unsigned int vertexCounts[] = { 2, 3, 5, 63, 64, 65, 130 };
+    const double probabilities[] = { 0.0, 1e-9, 0.02, 0.1, 0.3, 0.5, 1.0, 2.0 };
+    for (unsigned int n : vertexCounts)
+    {
+        for (double xi : probabilities)
+        {
+            mismatches += validateCase<Dim>(n, xi, random());
+        }
+    }
+
+    // Random parameters.
+    std::uniform_int_distribution<unsigned int> vertexDistribution(2, VALIDATION_MAX_VERTICES);
+    std::uniform_real_distribution<double> probabilityDistribution(0.0, 0.6);
+    for (unsigned int i = 0; i < VALIDATION_RANDOM_CASES; ++i)
+    {
+        unsigned int n = vertexDistribution(random);
+        double xi = probabilityDistribution(random);
+        mismatches += validateCase<Dim>(n, xi, random());
+    }
+
+    return mismatches;
+}
+
+template<unsigned int Dim>
+unsigned int EngineValidation::validateCase(unsigned int n, double xi, unsigned int seed)
+{
+    // Seed 0 would mean "random" for the graph, so it is skipped.
+    if (seed == RANDOM_SEED)
+        seed = 1;
+
+    // Every vertex engine gives different positions for the same seed, so each has its own reference graph.
+    std::vector<Graph<Dim>> references;
+    for (VertexEngine vertexEngine : { SEQUENTIAL_VERTICES, BULK_VERTICES })
+    {
+        GraphOptions referenceOptions;
+        referenceOptions.seed = seed;
+        referenceOptions.adjacencyEngine = SPARSE_ADJACENCY;
+        referenceOptions.vertexEngine = vertexEngine;
+        references.push_back(Graph<Dim>(n, xi, referenceOptions));
+    }
+
+    // Components and vertex probabilities of the reference are checked independently of the disjoint set and
+    // the distribution cache used by every engine.
+    const VertexProbabilities probabilities = calculateProbabilities(n, xi);
+    unsigned int mismatches = 0;
+    for (const Graph<Dim> & reference : references)
+    {
+        mismatches += checkComponents(reference);
+        mismatches += checkProbabilities(reference, probabilities);
+    }
+
+    for (ValidationEngine engine : getEngines())
+    {
+        const Graph<Dim> & reference = references[engine.options.vertexEngine];
+        engine.options.seed = seed;
+        if (engine.useSnapshot)
+        {
+            GraphSnapshot<Dim> snapshot;
+            if (!GraphSnapshot<Dim>::save(reference, VALIDATION_SNAPSHOT_FILE) || !snapshot.open(VALIDATION_SNAPSHOT_FILE))
+            {
+                logMismatch(engine.name, Dim, n, xi, seed, "snapshot file", 1.0, 0.0);
+                ++mismatches;
+                continue;
+            }
+
+            mismatches += compare(reference, Graph<Dim>(snapshot, engine.options), engine);
+        }
+        else
+        {
+            Graph<Dim> candidate(n, xi, engine.options);
+            mismatches += compare(reference, candidate, engine);
+
+            // Graphs without stored edges cannot be written as snapshots (they would reload without edges).
+            if (engine.options.metricSet == CONNECTIVITY_METRICS && GraphSnapshot<Dim>::save(candidate, VALIDATION_SNAPSHOT_FILE))
+            {
+                logMismatch(engine.name, Dim, n, xi, seed, "snapshot saved", 0.0, 1.0);
+                ++mismatches;
+            }
+        }
+    }
+
+    return mismatches;
+}
+
+template<unsigned int Dim>
+unsigned int EngineValidation::compare(const Graph<Dim> & reference, const Graph<Dim> & candidate, const ValidationEngine & engine)
+{
+    const ExactProperties expected = reference.getExactProperties();
+    const ExactProperties actual = candidate.getExactProperties();
+    const unsigned int n = reference.getVerticesCount();
+    const double xi = reference.getEdgeProbability();
+    const unsigned int seed = reference.getSeed();
+
+    unsigned int mismatches = 0;
+    auto checkExact = [&](const std::string & property, double expectedValue, double actualValue)
+    {
+        if (expectedValue != actualValue)
+        {
+            logMismatch(engine.name, Dim, n, xi, seed, property, expectedValue, actualValue);
+            ++mismatches;
+        }
+    };
+    auto checkClose = [&](const std::string & property, double expectedValue, double actualValue)
+    {
+        if (!isClose(expectedValue, actualValue))
+        {
+            logMismatch(engine.name, Dim, n, xi, seed, property, expectedValue, actualValue);
+            ++mismatches;
+        }
+    };
+
+    // Integer metrics (and the ones derived from integer sums in the same way) have to be identical.
+    checkExact("vertices", n, candidate.getVerticesCount());
+    checkExact("vertex engine", reference.getVertexEngine(), candidate.getVertexEngine());
+    checkExact("connected", expected.isConnected, actual.isConnected);
+    checkExact("component count", expected.componentCount, actual.componentCount);
+    checkExact("largest component size", expected.largestComponentSize, actual.largestComponentSize);
+    if (engine.options.metricSet == CONNECTIVITY_METRICS)
+        return mismatches;
+
+    checkExact("edge count", expected.edgeCount, actual.edgeCount);
+    checkExact("average degree", expected.averageDegree, actual.averageDegree);
+    checkExact("density", expected.density, actual.density);
+    if (getDegreeSequence(reference) != getDegreeSequence(candidate))
+    {
+        logMismatch(engine.name, Dim, n, xi, seed, "degree sequence", 0.0, 1.0);
+        ++mismatches;
+    }
+    if (engine.options.metricSet == EDGE_METRICS)
+        return mismatches;
+
+    checkExact("average path length", expected.averagePathLength, actual.averagePathLength);
+
+    // Floating point sums may be accumulated in different order.
+    checkClose("grouping factor", expected.groupingFactor, actual.groupingFactor);
+    checkClose("degree variance", expected.degreeVariance, actual.degreeVariance);
+    checkClose("normalized degree variance", expected.normalizedDegreeVariance, actual.normalizedDegreeVariance);
+    checkClose("average vertex probability", expected.averageVertexProbability, actual.averageVertexProbability);
+    checkClose("vertex probability variance", expected.vertexProbabilityVariance, actual.vertexProbabilityVariance);
+    mismatches += compareProbabilities(expected.vertexProbability.get(), actual.vertexProbability.get(),
+        "vertex probability", engine.name, reference);
+    mismatches += compareProbabilities(reference.getApproximateProperties().vertexProbability.get(),
+        candidate.getApproximateProperties().vertexProbability.get(), "approximate vertex probability", engine.name, reference);
+
+    return mismatches;
+}
+
+template<unsigned int Dim>
+unsigned int EngineValidation::compareProbabilities(const std::vector<double> * expected, const std::vector<double> * actual,
+    const std::string & property, const std::string & engine, const Graph<Dim> & reference)
+{
+    const unsigned int n = reference.getVerticesCount();
+    const double xi = reference.getEdgeProbability();
+    const unsigned int seed = reference.getSeed();
+
+    if (!expected || !actual || expected->size() != actual->size())
+    {
+        logMismatch(engine, Dim, n, xi, seed, property + " size",
+            expected ? (double)expected->size() : -1.0, actual ? (double)actual->size() : -1.0);
+        return 1;
+    }
+
+    // Report only the first different value, the rest of the distribution usually differs as well.
+    for (size_t k = 0; k < expected->size(); ++k)
+    {
+        if (!isClose((*expected)[k], (*actual)[k]))
+        {
+            logMismatch(engine, Dim, n, xi, seed, property + " [k = " + std::to_string(k) + "]", (*expected)[k], (*actual)[k]);
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+template<unsigned int Dim>
+unsigned int EngineValidation::checkProbabilities(const Graph<Dim> & graph, const VertexProbabilities & probabilities)
+{
+    const ExactProperties properties = graph.getExactProperties();
+    const std::string engine = "per-k vertex probabilities";
+    unsigned int mismatches = 0;
+    auto checkClose = [&](const std::string & property, double expectedValue, double actualValue)
+    {
+        if (!isClose(expectedValue, actualValue))
+        {
+            logMismatch(engine, Dim, graph.getVerticesCount(), graph.getEdgeProbability(), graph.getSeed(), property, expectedValue, actualValue);
+            ++mismatches;
+        }
+    };
+
+    mismatches += compareProbabilities(&probabilities.exact, properties.vertexProbability.get(), "vertex probability", engine, graph);
+    mismatches += compareProbabilities(&probabilities.approximate, graph.getApproximateProperties().vertexProbability.get(),
+        "approximate vertex probability", engine, graph);
+    checkClose("average vertex probability", probabilities.averageDifference, properties.averageVertexProbability);
+    checkClose("vertex probability variance", probabilities.differenceVariance, properties.vertexProbabilityVariance);
+
+    return mismatches;
+}
+
+template<unsigned int Dim>
+unsigned int EngineValidation::checkComponents(const Graph<Dim> & graph)
+{
+    const unsigned int n = graph.getVerticesCount();
+    const unsigned int unlabeled = n;
+
+    // Label every component with iterative breadth-first search (explicit queue, so long paths are fine).
+    std::vector<unsigned int> labels(n, unlabeled);
+    std::vector<unsigned int> queue;
+    unsigned int componentCount = 0;
+    unsigned int largestComponentSize = 0;
+    for (unsigned int root = 0; root < n; ++root)
+    {
+        if (labels[root] != unlabeled)
+            continue;
+
+        queue.assign(1, root);
+        labels[root] = componentCount;
+        for (size_t next = 0; next < queue.size(); ++next)
+        {
+            for (unsigned int adjacent : graph.getConnectedVerticesIndexes(queue[next]))
+            {
+                if (labels[adjacent] == unlabeled)
+                {
+                    labels[adjacent] = componentCount;
+                    queue.push_back(adjacent);
+                }
+            }
+        }
+
+        largestComponentSize = std::max(largestComponentSize, (unsigned int)queue.size());
+        ++componentCount;
+    }
+
+    const ExactProperties properties = graph.getExactProperties();
+    const std::string engine = "breadth-first components";
+    unsigned int mismatches = 0;
+    auto checkExact = [&](const std::string & property, double expectedValue, double actualValue)
+    {
+        if (expectedValue != actualValue)
+        {
+            logMismatch(engine, Dim, n, graph.getEdgeProbability(), graph.getSeed(), property, expectedValue, actualValue);
+            ++mismatches;
+        }
+    };
+
+    checkExact("connected", componentCount == 1, properties.isConnected);
+    checkExact("component count", componentCount, properties.componentCount);
+    checkExact("largest component size", largestComponentSize, properties.largestComponentSize);
+
+    return mismatches;
+}
+
+template<unsigned int Dim>
+std::vector<unsigned int> EngineValidation::getDegreeSequence(const Graph<Dim> & graph)
+{
+    std::vector<unsigned int> degrees;
+    for (unsigned int i = 0; i < graph.getVerticesCount(); ++i)
+    {
+        degrees.push_back(graph.getVertexDegree(i));
+    }
+
+    std::sort(degrees.begin(), degrees.end());
+    return degrees;
+}